@@ -0,0 +1,102 @@
+#include "CrvActorDescGraph.h"
+
+#include "CtrlReferenceVisualizer.h"
+#include "Engine/World.h"
+#include "WorldPartition/WorldPartition.h"
+#include "WorldPartition/WorldPartitionHelpers.h"
+
+#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 4
+#include "WorldPartition/WorldPartitionActorDescInstance.h"
+#else
+#include "WorldPartition/WorldPartitionActorDesc.h"
+#endif
+
+void FCrvActorDescGraph::Build(UWorld* InWorld)
+{
+	Reset();
+	World = InWorld;
+	bIsBuilt = true;
+	const auto WorldPartition = InWorld ? InWorld->GetWorldPartition() : nullptr;
+	if (!WorldPartition) { return; }
+
+	const double StartTime = FPlatformTime::Seconds();
+	TArray<TArray<FGuid>> References;
+	auto AddDesc = [this, &References](const auto* Desc)
+	{
+#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 3
+		const FBox Bounds = Desc->GetEditorBounds();
+#else
+		const FBox Bounds = Desc->GetBounds();
+#endif
+		NodeIds.Add(Desc->GetGuid(), Nodes.Num());
+		Nodes.Add({Desc->GetGuid(), Desc->GetActorLabel(), Desc->GetActorSoftPath(), Bounds});
+		References.Add(Desc->GetReferences());
+		return true;
+	};
+#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 4
+	FWorldPartitionHelpers::ForEachActorDescInstance(WorldPartition, [&AddDesc](const FWorldPartitionActorDescInstance* Desc) { return AddDesc(Desc); });
+#else
+	FWorldPartitionHelpers::ForEachActorDesc(WorldPartition, [&AddDesc](const FWorldPartitionActorDesc* Desc) { return AddDesc(Desc); });
+#endif
+
+	// count, then fill each direction's edges
+	OutOffsets.SetNumZeroed(Nodes.Num() + 1);
+	InOffsets.SetNumZeroed(Nodes.Num() + 1);
+	TArray<TPair<int32, int32>> Edges;
+	for (int32 Source = 0; Source < Nodes.Num(); ++Source)
+	{
+		for (const auto& Guid : References[Source])
+		{
+			if (const auto Target = NodeIds.Find(Guid))
+			{
+				Edges.Emplace(Source, *Target);
+				++OutOffsets[Source + 1];
+				++InOffsets[*Target + 1];
+			}
+		}
+	}
+	for (int32 Index = 0; Index < Nodes.Num(); ++Index)
+	{
+		OutOffsets[Index + 1] += OutOffsets[Index];
+		InOffsets[Index + 1] += InOffsets[Index];
+	}
+	OutEdges.SetNumUninitialized(Edges.Num());
+	InEdges.SetNumUninitialized(Edges.Num());
+	TArray<int32> OutNext(OutOffsets.GetData(), Nodes.Num());
+	TArray<int32> InNext(InOffsets.GetData(), Nodes.Num());
+	for (const auto& [Source, Target] : Edges)
+	{
+		OutEdges[OutNext[Source]++] = Target;
+		InEdges[InNext[Target]++] = Source;
+	}
+	UE_CLOG(FCrvModule::IsDebugEnabled(), LogCrv, Log, TEXT("Actor descriptors: %d actors, %d references in %.2fms"), Nodes.Num(), Edges.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+void FCrvActorDescGraph::Reset()
+{
+	Nodes.Reset();
+	NodeIds.Reset();
+	OutOffsets.Reset();
+	OutEdges.Reset();
+	InOffsets.Reset();
+	InEdges.Reset();
+	World.Reset();
+	bIsBuilt = false;
+}
+
+void FCrvActorDescGraph::GetUnloadedReferences(const FGuid& ActorGuid, const ECrvDirection Direction, TArray<const FCrvActorDescNode*>& OutNodes) const
+{
+	const auto Id = NodeIds.Find(ActorGuid);
+	if (!Id) { return; }
+	const auto& Offsets = Direction == ECrvDirection::Outgoing ? OutOffsets : InOffsets;
+	const auto& Edges = Direction == ECrvDirection::Outgoing ? OutEdges : InEdges;
+	for (int32 Index = Offsets[*Id]; Index < Offsets[*Id + 1]; ++Index)
+	{
+		const auto& Node = Nodes[Edges[Index]];
+		// loaded actors are found by the regular search
+		if (!Node.IsLoaded())
+		{
+			OutNodes.Add(&Node);
+		}
+	}
+}
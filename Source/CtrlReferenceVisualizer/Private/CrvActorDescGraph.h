@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CrvSettings.h"
+
+class UWorld;
+
+struct FCrvActorDescNode
+{
+	FGuid Guid;
+	FName Label;
+	FSoftObjectPath ActorPath;
+	FBox Bounds;
+
+	bool IsLoaded() const { return ActorPath.ResolveObject() != nullptr; }
+};
+
+/**
+ * Actor references recorded by World Partition actor descriptors, including actors in unloaded cells.
+ * Built from the descriptors in a single pass without loading any actors, edges are stored compressed by source actor.
+ */
+class FCrvActorDescGraph
+{
+public:
+	void Build(UWorld* InWorld);
+	void Reset();
+	bool IsBuiltFor(const UWorld* InWorld) const { return bIsBuilt && World.Get() == InWorld; }
+
+	// Descriptors of unloaded actors referenced by (Outgoing) or referencing (Incoming) the actor with ActorGuid
+	void GetUnloadedReferences(const FGuid& ActorGuid, ECrvDirection Direction, TArray<const FCrvActorDescNode*>& OutNodes) const;
+
+	int32 Num() const { return Nodes.Num(); }
+	int32 NumEdges() const { return OutEdges.Num(); }
+
+private:
+	TArray<FCrvActorDescNode> Nodes;
+	TMap<FGuid, int32> NodeIds;
+	// edges of node N are Edges[Offsets[N]..Offsets[N + 1]]
+	TArray<int32> OutOffsets;
+	TArray<int32> OutEdges;
+	TArray<int32> InOffsets;
+	TArray<int32> InEdges;
+
+	TWeakObjectPtr<UWorld> World;
+	bool bIsBuilt = false;
+};
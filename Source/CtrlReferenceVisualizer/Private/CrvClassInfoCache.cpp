@@ -0,0 +1,52 @@
+#include "CrvClassInfoCache.h"
+
+#include "Editor.h"
+
+#include "Engine/Blueprint.h"
+
+#include "Styling/SlateIconFinder.h"
+
+void FCrvClassInfoCache::Register()
+{
+	if (!GEditor) { return; }
+	BlueprintCompiledHandle = GEditor->OnBlueprintCompiled().AddRaw(this, &FCrvClassInfoCache::Reset);
+}
+
+void FCrvClassInfoCache::Unregister()
+{
+	if (GEditor)
+	{
+		GEditor->OnBlueprintCompiled().Remove(BlueprintCompiledHandle);
+	}
+	BlueprintCompiledHandle.Reset();
+	Reset();
+}
+
+FCrvClassInfo FCrvClassInfoCache::Get(const UClass* Class)
+{
+	if (!Class) { return FCrvClassInfo(); }
+	if (const auto Found = ClassInfos.Find(Class))
+	{
+		return *Found;
+	}
+
+	FCrvClassInfo Info;
+	if (const auto BP = UBlueprint::GetBlueprintFromClass(Class->GetAuthoritativeClass()))
+	{
+		Info.SectionName = FName(BP->GetFullName());
+		// get human-readable name from uobject
+		Info.Label = FText::FromString(BP->GetFriendlyName());
+	}
+	else
+	{
+		Info.SectionName = FName(Class->GetPathName());
+		Info.Label = FText::FromString(Class->GetName());
+	}
+	Info.Icon = FSlateIconFinder::FindIconForClass(Class);
+	return ClassInfos.Add(Class, MoveTemp(Info));
+}
+
+void FCrvClassInfoCache::Reset()
+{
+	ClassInfos.Reset();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Textures/SlateIcon.h"
+#include "UObject/ObjectKey.h"
+
+struct FCrvClassInfo
+{
+	// Blueprint classes are grouped by their Blueprint, native classes by class path
+	FName SectionName;
+	FText Label;
+	FSlateIcon Icon;
+};
+
+/**
+ * Per-class section name, label & icon used to group references in menus & lists.
+ * Cleared whenever a Blueprint is compiled, as compiling replaces the generated class.
+ */
+class FCrvClassInfoCache
+{
+public:
+	void Register();
+	void Unregister();
+
+	// By value, entries move when the map grows & are dropped on Reset
+	FCrvClassInfo Get(const UClass* Class);
+	void Reset();
+
+private:
+	TMap<TObjectKey<UClass>, FCrvClassInfo> ClassInfos;
+	FDelegateHandle BlueprintCompiledHandle;
+};
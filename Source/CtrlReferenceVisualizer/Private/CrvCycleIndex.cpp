@@ -0,0 +1,349 @@
+#include "CrvCycleIndex.h"
+
+#include "CrvTrace.h"
+#include "CtrlReferenceVisualizer.h"
+
+#include "Algo/Unique.h"
+
+#include "GameFramework/Actor.h"
+
+using namespace CtrlRefViz;
+
+namespace CtrlRefViz::Cycles
+{
+	// checking each added edge for a new cycle walks the graph, past this many a rebuild is cheaper
+	constexpr int32 MaxIncrementalAddedEdges = 16;
+	// nodes of removed actors are kept until they outnumber the live ones by this much
+	constexpr int32 MaxUnusedNodes = 1024;
+}
+
+void FCrvSccGraph::SetNumNodes(const int32 NumNodes)
+{
+	Edges.SetNum(NumNodes);
+	while (CycleOf.Num() < NumNodes)
+	{
+		CycleOf.Add(INDEX_NONE);
+	}
+}
+
+void FCrvSccGraph::SetEdges(const int32 Node, TArray<int32> Targets)
+{
+	Targets.Remove(Node);
+	Targets.Sort();
+	Targets.SetNum(Algo::Unique(Targets));
+	// diff the sorted edge lists, removals can only split the cycle they were in, additions can only merge
+	const auto& Old = Edges[Node];
+	int32 OldIndex = 0;
+	int32 NewIndex = 0;
+	while (OldIndex < Old.Num() || NewIndex < Targets.Num())
+	{
+		if (NewIndex >= Targets.Num() || (OldIndex < Old.Num() && Old[OldIndex] < Targets[NewIndex]))
+		{
+			const int32 Cycle = CycleOf[Node];
+			if (Cycle != INDEX_NONE && Cycle == CycleOf[Old[OldIndex]])
+			{
+				DirtyCycles.Add(Cycle);
+			}
+			++OldIndex;
+		}
+		else if (OldIndex >= Old.Num() || Targets[NewIndex] < Old[OldIndex])
+		{
+			check(Edges.IsValidIndex(Targets[NewIndex]));
+			AddedEdges.Add({Node, Targets[NewIndex]});
+			++NewIndex;
+		}
+		else
+		{
+			++OldIndex;
+			++NewIndex;
+		}
+	}
+	Edges[Node] = MoveTemp(Targets);
+}
+
+void FCrvSccGraph::Update()
+{
+	if (AddedEdges.Num() > CtrlRefViz::Cycles::MaxIncrementalAddedEdges)
+	{
+		Rebuild();
+		return;
+	}
+	for (const auto& [From, To] : AddedEdges)
+	{
+		const int32 Cycle = CycleOf[From];
+		if (Cycle != INDEX_NONE && Cycle == CycleOf[To]) { continue; }
+		// an edge between different components only changes them if it closes a cycle
+		if (CanReach(To, From))
+		{
+			Rebuild();
+			return;
+		}
+	}
+	AddedEdges.Reset();
+	if (DirtyCycles.IsEmpty()) { return; }
+
+	// a cycle that lost edges can only split into smaller cycles of its own nodes
+	TBitArray<> Subset(false, Edges.Num());
+	TArray<int32> Starts;
+	for (const int32 Cycle : DirtyCycles)
+	{
+		for (const int32 Node : Cycles[Cycle])
+		{
+			Subset[Node] = true;
+			Starts.Add(Node);
+		}
+		RemoveCycle(Cycle);
+	}
+	DirtyCycles.Reset();
+	FindComponents(Starts, &Subset);
+}
+
+void FCrvSccGraph::Rebuild()
+{
+	Cycles.Reset();
+	CycleOf.Init(INDEX_NONE, Edges.Num());
+	AddedEdges.Reset();
+	DirtyCycles.Reset();
+	TArray<int32> Starts;
+	Starts.SetNumUninitialized(Edges.Num());
+	for (int32 Node = 0; Node < Edges.Num(); ++Node)
+	{
+		Starts[Node] = Node;
+	}
+	FindComponents(Starts, nullptr);
+}
+
+void FCrvSccGraph::Reset()
+{
+	Edges.Reset();
+	CycleOf.Reset();
+	Cycles.Reset();
+	AddedEdges.Reset();
+	DirtyCycles.Reset();
+}
+
+void FCrvSccGraph::FindComponents(const TArray<int32>& Starts, const TBitArray<>* Subset)
+{
+	CRV_TRACE_SCOPE("Crv::FindComponents");
+	const int32 Num = Edges.Num();
+	TArray<int32> Index;
+	Index.Init(INDEX_NONE, Num);
+	TArray<int32> LowLink;
+	LowLink.SetNumUninitialized(Num);
+	TBitArray<> OnStack(false, Num);
+	TArray<int32> Stack;
+
+	// explicit call stack instead of recursion, each frame resumes at its next edge
+	struct FFrame
+	{
+		int32 Node;
+		int32 NextEdge;
+	};
+	TArray<FFrame> CallStack;
+	int32 Counter = 0;
+	auto Visit = [&](const int32 Node)
+	{
+		Index[Node] = Counter;
+		LowLink[Node] = Counter;
+		++Counter;
+		Stack.Add(Node);
+		OnStack[Node] = true;
+		CallStack.Add({Node, 0});
+	};
+
+	for (const int32 Start : Starts)
+	{
+		if (Index[Start] != INDEX_NONE) { continue; }
+		Visit(Start);
+		while (CallStack.Num())
+		{
+			const int32 Node = CallStack.Last().Node;
+			const auto& NodeEdges = Edges[Node];
+			if (CallStack.Last().NextEdge < NodeEdges.Num())
+			{
+				const int32 Target = NodeEdges[CallStack.Last().NextEdge++];
+				if (Subset && !(*Subset)[Target]) { continue; }
+				if (Index[Target] == INDEX_NONE)
+				{
+					Visit(Target);
+				}
+				else if (OnStack[Target])
+				{
+					LowLink[Node] = FMath::Min(LowLink[Node], Index[Target]);
+				}
+				continue;
+			}
+
+			CallStack.Pop();
+			if (CallStack.Num())
+			{
+				const int32 Parent = CallStack.Last().Node;
+				LowLink[Parent] = FMath::Min(LowLink[Parent], LowLink[Node]);
+			}
+			if (LowLink[Node] != Index[Node]) { continue; }
+			// most nodes aren't in a cycle, skip building a component for them
+			if (Stack.Last() == Node)
+			{
+				Stack.Pop();
+				OnStack[Node] = false;
+				continue;
+			}
+			TArray<int32> Component;
+			int32 Member;
+			do
+			{
+				Member = Stack.Pop();
+				OnStack[Member] = false;
+				Component.Add(Member);
+			}
+			while (Member != Node);
+			const int32 Cycle = Cycles.Add(MoveTemp(Component));
+			for (const int32 CycleNode : Cycles[Cycle])
+			{
+				CycleOf[CycleNode] = Cycle;
+			}
+		}
+	}
+}
+
+bool FCrvSccGraph::CanReach(const int32 From, const int32 To) const
+{
+	TBitArray<> Visited(false, Edges.Num());
+	TArray<int32> Stack = {From};
+	Visited[From] = true;
+	while (Stack.Num())
+	{
+		const int32 Node = Stack.Pop();
+		if (Node == To) { return true; }
+		for (const int32 Target : Edges[Node])
+		{
+			if (Visited[Target]) { continue; }
+			Visited[Target] = true;
+			Stack.Add(Target);
+		}
+	}
+	return false;
+}
+
+void FCrvSccGraph::RemoveCycle(const int32 Cycle)
+{
+	for (const int32 Node : Cycles[Cycle])
+	{
+		CycleOf[Node] = INDEX_NONE;
+	}
+	Cycles.RemoveAt(Cycle);
+}
+
+void FCrvCycleIndex::Update(const FCrvObjectGraph& Outgoing)
+{
+	CRV_TRACE_SCOPE("Crv::UpdateCycles");
+	// nodes aren't removed, start over once removed actors dominate
+	if (Actors.Num() > Outgoing.Num() * 2 + CtrlRefViz::Cycles::MaxUnusedNodes)
+	{
+		Reset();
+	}
+	TMap<int32, TArray<int32>> NewEdges;
+	NewEdges.Reserve(Outgoing.Num());
+	for (const auto& [Root, Leaves] : Outgoing)
+	{
+		const auto RootActor = GetOwner(Root.Get());
+		if (!IsValid(RootActor)) { continue; }
+		auto& Targets = NewEdges.FindOrAdd(FindOrAddNode(RootActor));
+		for (const auto Leaf : Leaves)
+		{
+			const auto LeafActor = GetOwner(Leaf);
+			if (!IsValid(LeafActor) || LeafActor == RootActor) { continue; }
+			Targets.Add(FindOrAddNode(LeafActor));
+		}
+	}
+	// only nodes whose edges differ are passed on as changes
+	Graph.SetNumNodes(Actors.Num());
+	for (int32 Node = 0; Node < Actors.Num(); ++Node)
+	{
+		if (const auto Found = NewEdges.Find(Node))
+		{
+			Graph.SetEdges(Node, MoveTemp(*Found));
+		}
+		else if (Graph.GetEdges(Node).Num())
+		{
+			Graph.SetEdges(Node, {});
+		}
+	}
+	Graph.Update();
+	UE_CLOG(FCrvModule::IsDebugEnabled(), LogCrv, Log, TEXT("UpdateCycles: %d cycles in %d actors"), NumCycles(), Actors.Num());
+}
+
+void FCrvCycleIndex::Reset()
+{
+	Graph.Reset();
+	Actors.Reset();
+	NodeIndices.Reset();
+}
+
+bool FCrvCycleIndex::IsInCycle(const UObject* Object) const
+{
+	const int32 Node = FindNode(Object);
+	return Node != INDEX_NONE && Graph.GetCycle(Node) != INDEX_NONE;
+}
+
+bool FCrvCycleIndex::IsInSameCycle(const UObject* A, const UObject* B) const
+{
+	const int32 NodeA = FindNode(A);
+	const int32 NodeB = FindNode(B);
+	if (NodeA == INDEX_NONE || NodeB == INDEX_NONE || NodeA == NodeB) { return false; }
+	const int32 Cycle = Graph.GetCycle(NodeA);
+	return Cycle != INDEX_NONE && Cycle == Graph.GetCycle(NodeB);
+}
+
+TArray<TArray<AActor*>> FCrvCycleIndex::GetCycles() const
+{
+	TArray<TArray<AActor*>> Result;
+	Result.Reserve(NumCycles());
+	for (const auto& Cycle : Graph.GetCycles())
+	{
+		auto& CycleActors = Result.AddDefaulted_GetRef();
+		for (const int32 Node : Cycle)
+		{
+			if (const auto Actor = Actors[Node].Get())
+			{
+				CycleActors.Add(Actor);
+			}
+		}
+	}
+	Result.Sort([](const TArray<AActor*>& A, const TArray<AActor*>& B) { return A.Num() > B.Num(); });
+	return Result;
+}
+
+void FCrvCycleIndex::Log() const
+{
+	const auto Cycles = GetCycles();
+	UE_LOG(LogCrv, Display, TEXT("Reference cycles: %d"), Cycles.Num());
+	for (const auto& Cycle : Cycles)
+	{
+		TArray<FString> Names;
+		for (const auto Actor : Cycle)
+		{
+			Names.Add(GetDebugName(Actor));
+		}
+		UE_LOG(LogCrv, Display, TEXT("\t%d actors: %s"), Cycle.Num(), *FString::Join(Names, TEXT(", ")));
+	}
+}
+
+int32 FCrvCycleIndex::FindNode(const UObject* Object) const
+{
+	const auto Actor = GetOwner(Object);
+	if (!Actor) { return INDEX_NONE; }
+	const auto Found = NodeIndices.Find(Actor);
+	return Found ? *Found : INDEX_NONE;
+}
+
+int32 FCrvCycleIndex::FindOrAddNode(AActor* Actor)
+{
+	if (const auto Found = NodeIndices.Find(Actor))
+	{
+		return *Found;
+	}
+	const int32 Node = Actors.Add(Actor);
+	NodeIndices.Add(Actor, Node);
+	return Node;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CrvUtils.h"
+#include "UObject/ObjectKey.h"
+
+/**
+ * Strongly connected components of a graph of integer nodes, kept up to date as node edges change.
+ * Only components of more than one node (cycles) are stored.
+ * Removing edges recomputes just the cycle they were in, adding edges only rebuilds if they close a new cycle.
+ * Components are found with an iterative Tarjan search, so long reference chains can't overflow the stack.
+ */
+class FCrvSccGraph
+{
+public:
+	void SetNumNodes(int32 NumNodes);
+	int32 NumNodes() const { return Edges.Num(); }
+	// Replace the outgoing edges of Node, components are updated by Update
+	void SetEdges(int32 Node, TArray<int32> Targets);
+	const TArray<int32>& GetEdges(int32 Node) const { return Edges[Node]; }
+	void Update();
+	void Rebuild();
+	void Reset();
+
+	// Cycle Node is in, INDEX_NONE if it isn't in one
+	int32 GetCycle(const int32 Node) const { return CycleOf.IsValidIndex(Node) ? CycleOf[Node] : INDEX_NONE; }
+	const TSparseArray<TArray<int32>>& GetCycles() const { return Cycles; }
+
+private:
+	// Finds components among Starts & the nodes reachable from them, only following edges into Subset if set
+	void FindComponents(const TArray<int32>& Starts, const TBitArray<>* Subset);
+	bool CanReach(int32 From, int32 To) const;
+	void RemoveCycle(int32 Cycle);
+
+	// sorted & unique per node
+	TArray<TArray<int32>> Edges;
+	TArray<int32> CycleOf;
+	TSparseArray<TArray<int32>> Cycles;
+
+	// changes since the last Update
+	TArray<TPair<int32, int32>> AddedEdges;
+	TSet<int32> DirtyCycles;
+};
+
+/**
+ * Cycles of actor references in the cached outgoing graph.
+ * Components & subobjects count as their owning actor, references within an actor are ignored.
+ * Only references of cached roots are known, so cycles are complete in All mode.
+ */
+class FCrvCycleIndex
+{
+public:
+	void Update(const FCrvObjectGraph& Outgoing);
+	void Reset();
+
+	bool IsInCycle(const UObject* Object) const;
+	// Whether A & B belong to different actors in the same cycle
+	bool IsInSameCycle(const UObject* A, const UObject* B) const;
+	// Actors of each cycle, largest first
+	TArray<TArray<AActor*>> GetCycles() const;
+	int32 NumCycles() const { return Graph.GetCycles().Num(); }
+	void Log() const;
+
+private:
+	int32 FindNode(const UObject* Object) const;
+	int32 FindOrAddNode(AActor* Actor);
+
+	FCrvSccGraph Graph;
+	TArray<TWeakObjectPtr<AActor>> Actors;
+	TMap<TObjectKey<AActor>, int32> NodeIndices;
+};
@@ -0,0 +1,90 @@
+#include "CrvDegreeStats.h"
+
+#include "CrvTrace.h"
+#include "CtrlReferenceVisualizer.h"
+
+#include "GameFramework/Actor.h"
+
+using namespace CtrlRefViz;
+
+FCrvDegreeStats FCrvDegreeStats::Compute(const TArray<AActor*>& Actors, const FCrvObjectGraph& Outgoing)
+{
+	CRV_TRACE_SCOPE("Crv::DegreeStats");
+	FCrvDegreeStats Stats;
+	TMap<const AActor*, int32> ActorIndices;
+	ActorIndices.Reserve(Actors.Num());
+	Stats.Degrees.Reserve(Actors.Num());
+	for (const auto Actor : Actors)
+	{
+		ActorIndices.Add(Actor, Stats.Degrees.Num());
+		Stats.Degrees.Add({Actor});
+	}
+
+	// one pass over the edges, each actor pair packed into a key to count it once
+	TSet<uint64> Edges;
+	for (const auto& [Root, Leaves] : Outgoing)
+	{
+		const auto SourceIndex = ActorIndices.Find(GetOwner(Root.Get()));
+		if (!SourceIndex) { continue; }
+		for (const auto Leaf : Leaves)
+		{
+			const auto TargetIndex = ActorIndices.Find(GetOwner(Leaf));
+			if (!TargetIndex || *TargetIndex == *SourceIndex) { continue; }
+			bool bIsCounted = false;
+			Edges.Add(static_cast<uint64>(*SourceIndex) << 32 | static_cast<uint32>(*TargetIndex), &bIsCounted);
+			if (bIsCounted) { continue; }
+			++Stats.Degrees[*SourceIndex].Outgoing;
+			++Stats.Degrees[*TargetIndex].Incoming;
+		}
+	}
+	Stats.NumEdges = Edges.Num();
+
+	for (const auto& Degree : Stats.Degrees)
+	{
+		const int32 Total = Degree.Total();
+		const int32 Bucket = Total ? FMath::FloorLog2(Total) + 1 : 0;
+		if (Stats.Histogram.Num() <= Bucket)
+		{
+			Stats.Histogram.SetNumZeroed(Bucket + 1);
+		}
+		++Stats.Histogram[Bucket];
+	}
+	return Stats;
+}
+
+TArray<FCrvActorDegree> FCrvDegreeStats::GetTopK(const int32 K, const ECrvDegreeSort Sort) const
+{
+	// heap of all degrees, only the top K are popped
+	auto Higher = [Sort](const FCrvActorDegree& A, const FCrvActorDegree& B) { return A.Get(Sort) > B.Get(Sort); };
+	TArray<FCrvActorDegree> Heap = Degrees;
+	Heap.Heapify(Higher);
+	TArray<FCrvActorDegree> Top;
+	Top.Reserve(FMath::Min(K, Heap.Num()));
+	while (Top.Num() < K && Heap.Num())
+	{
+		Heap.HeapPop(Top.AddDefaulted_GetRef(), Higher);
+	}
+	return Top;
+}
+
+FString FCrvDegreeStats::GetBucketLabel(const int32 Bucket)
+{
+	if (Bucket <= 1) { return FString::FromInt(Bucket); }
+	const int32 Min = 1 << (Bucket - 1);
+	return FString::Printf(TEXT("%d-%d"), Min, Min * 2 - 1);
+}
+
+void FCrvDegreeStats::Log(const int32 K, const ECrvDegreeSort Sort) const
+{
+	UE_LOG(LogCrv, Display, TEXT("Reference degrees: %d actors, %d actor references"), Degrees.Num(), NumEdges);
+	UE_LOG(LogCrv, Display, TEXT("Top %d hubs:"), K);
+	for (const auto& Degree : GetTopK(K, Sort))
+	{
+		UE_LOG(LogCrv, Display, TEXT("\t%5d in %5d out  %s"), Degree.Incoming, Degree.Outgoing, *GetDebugName(Degree.Actor.Get()));
+	}
+	UE_LOG(LogCrv, Display, TEXT("Actors by references (in + out):"));
+	for (int32 Bucket = 0; Bucket < Histogram.Num(); ++Bucket)
+	{
+		UE_LOG(LogCrv, Display, TEXT("\t%12s %d"), *GetBucketLabel(Bucket), Histogram[Bucket]);
+	}
+}
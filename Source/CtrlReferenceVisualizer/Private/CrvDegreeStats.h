@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CrvUtils.h"
+
+enum class ECrvDegreeSort : uint8
+{
+	Total,
+	Incoming,
+	Outgoing,
+};
+
+struct FCrvActorDegree
+{
+	TWeakObjectPtr<AActor> Actor;
+	int32 Incoming = 0;
+	int32 Outgoing = 0;
+
+	int32 Total() const { return Incoming + Outgoing; }
+	int32 Get(const ECrvDegreeSort Sort) const
+	{
+		return Sort == ECrvDegreeSort::Incoming ? Incoming : Sort == ECrvDegreeSort::Outgoing ? Outgoing : Total();
+	}
+};
+
+/**
+ * Incoming & outgoing reference counts of every actor, from one outgoing graph.
+ * Incoming counts come from inverting the outgoing edges, so no actor needs an incoming search.
+ * Components & subobjects count as their owning actor, references between the same two actors count once.
+ */
+struct FCrvDegreeStats
+{
+	// one per actor, in the order they were passed to Compute
+	TArray<FCrvActorDegree> Degrees;
+	// actors per total degree, bucket 0 is degree 0 & bucket N is degrees [2^(N-1), 2^N)
+	TArray<int32> Histogram;
+	int32 NumEdges = 0;
+
+	// Edges to actors not in Actors are ignored
+	static FCrvDegreeStats Compute(const TArray<AActor*>& Actors, const FCrvObjectGraph& Outgoing);
+
+	// K actors with the highest degree, highest first
+	TArray<FCrvActorDegree> GetTopK(int32 K, ECrvDegreeSort Sort) const;
+	static FString GetBucketLabel(int32 Bucket);
+	void Log(int32 K, ECrvDegreeSort Sort) const;
+};
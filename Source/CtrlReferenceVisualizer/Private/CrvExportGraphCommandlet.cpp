@@ -0,0 +1,363 @@
+#include "CrvExportGraphCommandlet.h"
+
+#include "CrvExternalActorScanner.h"
+#include "CrvGraphFile.h"
+#include "CrvRefSearch.h"
+#include "CtrlReferenceVisualizer.h"
+#include "Editor.h"
+#include "EngineUtils.h"
+#include "ReferenceVisualizerComponent.h"
+
+#include "Async/ParallelFor.h"
+
+#include "HAL/FileManager.h"
+
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+
+#include "Policies/CondensedJsonPrintPolicy.h"
+
+#include "Serialization/JsonWriter.h"
+
+#include "WorldPartition/WorldPartition.h"
+
+#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 1
+#include "WorldPartition/WorldPartitionEditorLoaderAdapter.h"
+#include "WorldPartition/LoaderAdapter/LoaderAdapterShape.h"
+#endif
+
+namespace CtrlRefViz::Export
+{
+	constexpr int32 FormatVersion = 1;
+	constexpr int32 DefaultBatchSize = 256;
+
+	struct FEdge
+	{
+		ECrvDirection Direction;
+		UObject* Root;
+		UObject* Leaf;
+		ECrvObjectKind Kind;
+		// into the batch's target objects, one set per root
+		int32 TargetsIndex;
+	};
+
+	static const TCHAR* LexToString(const ECrvDirection Direction)
+	{
+		return Direction == ECrvDirection::Outgoing ? TEXT("outgoing") : TEXT("incoming");
+	}
+
+	static const TCHAR* LexToString(const ECrvObjectKind Kind)
+	{
+		switch (Kind)
+		{
+			case ECrvObjectKind::Actor: return TEXT("actor");
+			case ECrvObjectKind::Component: return TEXT("component");
+			default: return TEXT("object");
+		}
+	}
+
+	static UWorld* LoadWorld(const FString& MapName)
+	{
+		FString PackageName;
+		if (!FPackageName::SearchForPackageOnDisk(MapName, &PackageName)) { return nullptr; }
+		const auto Package = LoadPackage(nullptr, *PackageName, LOAD_None);
+		const auto World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+		if (!World) { return nullptr; }
+
+		World->WorldType = EWorldType::Editor;
+		World->AddToRoot();
+		if (!World->bIsWorldInitialized)
+		{
+			World->InitWorld(
+				UWorld::InitializationValues()
+				.RequiresHitProxies(false)
+				.ShouldSimulatePhysics(false)
+				.EnableTraceCollision(false)
+				.CreateNavigation(false)
+				.CreateAISystem(false)
+				.AllowAudioPlayback(false)
+				.CreatePhysicsScene(false)
+			);
+		}
+		World->UpdateWorldComponents(true, false);
+		GEditor->GetEditorWorldContext(true).SetCurrentWorld(World);
+		GWorld = World;
+		return World;
+	}
+
+	// Referencers are only found if they are loaded, so load every World Partition cell
+	static void LoadAllActors(UWorld* World)
+	{
+		const auto WorldPartition = World->GetWorldPartition();
+		if (!WorldPartition) { return; }
+#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 1
+		const FBox AllBounds(FVector(-HALF_WORLD_MAX), FVector(HALF_WORLD_MAX));
+		const auto EditorLoaderAdapter = WorldPartition->CreateEditorLoaderAdapter<FLoaderAdapterShape>(World, AllBounds, TEXT("CrvExportGraph"));
+		EditorLoaderAdapter->GetLoaderAdapter()->Load();
+#else
+		UE_LOG(LogCrv, Warning, TEXT("CrvExportGraph: loading World Partition cells requires UE 5.1, only loaded actors are exported"));
+#endif
+	}
+
+	static FString MakeHeaderLine(const FString& MapPackageName, const int32 NumActors)
+	{
+		FString Line;
+		const auto Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Line);
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("format"), TEXT("crv-graph"));
+		Writer->WriteValue(TEXT("version"), FormatVersion);
+		Writer->WriteValue(TEXT("map"), MapPackageName);
+		Writer->WriteValue(TEXT("actors"), NumActors);
+		Writer->WriteObjectEnd();
+		Writer->Close();
+		return Line;
+	}
+
+	static FString MakeEdgeLine(const FEdge& Edge, const FCrvSet& TargetObjects)
+	{
+		FString Line;
+		const auto Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Line);
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("direction"), LexToString(Edge.Direction));
+		Writer->WriteValue(TEXT("root"), Edge.Root->GetPathName());
+		Writer->WriteValue(TEXT("leaf"), Edge.Leaf->GetPathName());
+		Writer->WriteValue(TEXT("kind"), LexToString(Edge.Kind));
+		Writer->WriteArrayStart(TEXT("paths"));
+		for (const auto& Path : Search::FindReferencePaths(Edge.Root, TargetObjects, Edge.Leaf, Edge.Direction))
+		{
+			Writer->WriteValue(Path);
+		}
+		Writer->WriteArrayEnd();
+		Writer->WriteObjectEnd();
+		Writer->Close();
+		return Line;
+	}
+
+	static void WriteLine(FArchive& Ar, const FString& Line)
+	{
+		const FTCHARToUTF8 Utf8(*Line);
+		Ar.Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Utf8.Length());
+		ANSICHAR NewLine = '\n';
+		Ar.Serialize(&NewLine, 1);
+	}
+
+	// Actor references read from external actor package headers, without loading the map
+	static bool ExportHeaders(const FString& MapName, const FString& OutputPath, const bool bOutgoing, const bool bIncoming)
+	{
+		FString PackageName;
+		FCrvExternalActorScanner Scanner;
+		if (!FPackageName::SearchForPackageOnDisk(MapName, &PackageName) || !Scanner.Scan(PackageName))
+		{
+			UE_LOG(LogCrv, Error, TEXT("CrvExportGraph: %s is not a map with external actors"), *MapName);
+			return false;
+		}
+		const TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileWriter(*OutputPath));
+		if (!Ar)
+		{
+			UE_LOG(LogCrv, Error, TEXT("CrvExportGraph: could not write %s"), *OutputPath);
+			return false;
+		}
+		WriteLine(*Ar, MakeHeaderLine(PackageName, Scanner.Num()));
+		for (int32 Index = 0; Index < Scanner.Num(); ++Index)
+		{
+			for (const auto Direction : {ECrvDirection::Outgoing, ECrvDirection::Incoming})
+			{
+				if (!(Direction == ECrvDirection::Outgoing ? bOutgoing : bIncoming)) { continue; }
+				for (const int32 Other : Scanner.GetReferences(Index, Direction))
+				{
+					const bool bSoft = Direction == ECrvDirection::Outgoing ? Scanner.IsSoftReference(Index, Other) : Scanner.IsSoftReference(Other, Index);
+					FString Line;
+					const auto Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Line);
+					Writer->WriteObjectStart();
+					Writer->WriteValue(TEXT("direction"), LexToString(Direction));
+					Writer->WriteValue(TEXT("root"), Scanner.GetActorPath(Index));
+					Writer->WriteValue(TEXT("leaf"), Scanner.GetActorPath(Other));
+					Writer->WriteValue(TEXT("kind"), LexToString(ECrvObjectKind::Actor));
+					Writer->WriteValue(TEXT("soft"), bSoft);
+					Writer->WriteObjectEnd();
+					Writer->Close();
+					WriteLine(*Ar, Line);
+				}
+			}
+		}
+		Ar->Close();
+		UE_LOG(LogCrv, Display, TEXT("CrvExportGraph: wrote %d actors from package headers to %s"), Scanner.Num(), *OutputPath);
+		return true;
+	}
+}
+
+UCrvExportGraphCommandlet::UCrvExportGraphCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UCrvExportGraphCommandlet::Main(const FString& Params)
+{
+	using namespace CtrlRefViz::Export;
+
+	FString MapName;
+	if (!FParse::Value(*Params, TEXT("Map="), MapName))
+	{
+		UE_LOG(LogCrv, Error, TEXT("CrvExportGraph: missing -Map=<Map>"));
+		return 1;
+	}
+	FString Format = TEXT("Json");
+	FParse::Value(*Params, TEXT("Format="), Format);
+	const bool bHeadersOnly = FParse::Param(*Params, TEXT("HeadersOnly"));
+	UE_CLOG(bHeadersOnly && Format == TEXT("Binary"), LogCrv, Warning, TEXT("CrvExportGraph: -HeadersOnly only writes Json"));
+	const bool bBinary = Format == TEXT("Binary") && !bHeadersOnly;
+	FString OutputPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("CrvExportGraph"), FPaths::GetBaseFilename(MapName) + (bBinary ? TEXT(".crvg") : TEXT(".jsonl")));
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	FString DirectionName = TEXT("Both");
+	FParse::Value(*Params, TEXT("Direction="), DirectionName);
+	const bool bOutgoing = DirectionName != TEXT("Incoming");
+	const bool bIncoming = DirectionName != TEXT("Outgoing");
+	int32 BatchSize = DefaultBatchSize;
+	FParse::Value(*Params, TEXT("BatchSize="), BatchSize);
+	BatchSize = FMath::Max(1, BatchSize);
+
+	if (bHeadersOnly)
+	{
+		return ExportHeaders(MapName, OutputPath, bOutgoing, bIncoming) ? 0 : 1;
+	}
+
+	const auto World = LoadWorld(MapName);
+	if (!World)
+	{
+		UE_LOG(LogCrv, Error, TEXT("CrvExportGraph: could not load map %s"), *MapName);
+		return 1;
+	}
+	LoadAllActors(World);
+
+	// sorted so reports from different runs can be diffed
+	TArray<AActor*> Actors;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (IsValid(*It))
+		{
+			Actors.Add(*It);
+		}
+	}
+	TArray<FString> ActorPaths;
+	ActorPaths.Reserve(Actors.Num());
+	for (const auto Actor : Actors)
+	{
+		ActorPaths.Add(Actor->GetPathName());
+	}
+	TArray<int32> Order;
+	Order.Reserve(Actors.Num());
+	for (int32 Index = 0; Index < Actors.Num(); ++Index)
+	{
+		Order.Add(Index);
+	}
+	Order.Sort([&ActorPaths](const int32 A, const int32 B) { return ActorPaths[A] < ActorPaths[B]; });
+
+	TUniquePtr<FArchive> Ar;
+	if (!bBinary)
+	{
+		Ar.Reset(IFileManager::Get().CreateFileWriter(*OutputPath));
+		if (!Ar)
+		{
+			UE_LOG(LogCrv, Error, TEXT("CrvExportGraph: could not write %s"), *OutputPath);
+			return 1;
+		}
+		WriteLine(*Ar, MakeHeaderLine(World->GetOutermost()->GetName(), Actors.Num()));
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	int64 NumEdges = 0;
+	// the binary format's node table needs every object up front, so it is written once all actors are searched
+	FCrvObjectGraph AllOutRefs;
+	FCrvObjectGraph AllInRefs;
+	for (int32 BatchStart = 0; BatchStart < Order.Num(); BatchStart += BatchSize)
+	{
+		const int32 BatchEnd = FMath::Min(BatchStart + BatchSize, Order.Num());
+		FCrvSet Roots;
+		for (int32 Index = BatchStart; Index < BatchEnd; ++Index)
+		{
+			Roots.Add(Actors[Order[Index]]);
+		}
+
+		// reference finding walks the object hash & must stay on the game thread
+		FCrvObjectGraph OutRefs;
+		FCrvObjectGraph InRefs;
+		if (bOutgoing)
+		{
+			FCrvRefSearch::FindOutRefs(Roots, OutRefs);
+		}
+		if (bIncoming)
+		{
+			// one referencer scan for the whole batch
+			FCrvRefSearch::FindInRefsBatched(Roots, InRefs);
+		}
+		if (bBinary)
+		{
+			NumEdges += CountEdges(OutRefs) + CountEdges(InRefs);
+			AllOutRefs.Append(MoveTemp(OutRefs));
+			AllInRefs.Append(MoveTemp(InRefs));
+			UE_LOG(LogCrv, Display, TEXT("CrvExportGraph: %d/%d actors, %lld references"), BatchEnd, Order.Num(), NumEdges);
+			continue;
+		}
+
+		TArray<FCrvSet> Targets;
+		TMap<UObject*, int32> TargetsIndices;
+		TArray<FEdge> Edges;
+		const auto AddEdges = [&](const FCrvObjectGraph& Graph, const ECrvDirection Direction)
+		{
+			for (const auto& [Root, Leaves] : Graph)
+			{
+				auto* TargetsIndex = TargetsIndices.Find(Root);
+				if (!TargetsIndex)
+				{
+					TargetsIndex = &TargetsIndices.Add(Root, Targets.Add(Search::FindTargetObjects(Root)));
+				}
+				for (const auto Leaf : Leaves)
+				{
+					if (!IsValid(Leaf)) { continue; }
+					// kinds are memoized in a map that isn't thread safe, resolve them before formatting in parallel
+					Edges.Add({Direction, Root, Leaf, UReferenceVisualizerComponent::GetObjectKind(Leaf->GetClass()), *TargetsIndex});
+				}
+			}
+		};
+		AddEdges(OutRefs, ECrvDirection::Outgoing);
+		AddEdges(InRefs, ECrvDirection::Incoming);
+
+		// property paths only read objects, nothing is collected until the batch is written
+		TArray<FString> Lines;
+		Lines.SetNum(Edges.Num());
+		ParallelFor(Edges.Num(), [&Lines, &Edges, &Targets](const int32 Index)
+		{
+			Lines[Index] = MakeEdgeLine(Edges[Index], Targets[Edges[Index].TargetsIndex]);
+		});
+		Lines.Sort();
+		for (const auto& Line : Lines)
+		{
+			WriteLine(*Ar, Line);
+		}
+		Ar->Flush();
+		NumEdges += Lines.Num();
+		UE_LOG(LogCrv, Display, TEXT("CrvExportGraph: %d/%d actors, %lld references"), BatchEnd, Order.Num(), NumEdges);
+	}
+
+	if (bBinary)
+	{
+		if (!FCrvGraphFile::Save(OutputPath, AllOutRefs, AllInRefs)) { return 1; }
+	}
+	else
+	{
+		Ar->Close();
+	}
+	UE_LOG(
+		LogCrv,
+		Display,
+		TEXT("CrvExportGraph: wrote %lld references from %d actors to %s in %.2fs"),
+		NumEdges,
+		Actors.Num(),
+		*OutputPath,
+		FPlatformTime::Seconds() - StartTime
+	);
+	return 0;
+}
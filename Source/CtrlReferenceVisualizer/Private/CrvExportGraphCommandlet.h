@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CrvExportGraphCommandlet.generated.h"
+
+/**
+ * Writes the outgoing & incoming reference graph of a map without opening the editor, e.g. for nightly reports.
+ * UnrealEditor-Cmd <Project> -run=CrvExportGraph -Map=/Game/Maps/MyMap [-Output=<File>] [-Direction=Both|Outgoing|Incoming] [-BatchSize=256] [-Format=Json|Binary]
+ * Actors are searched in batches with the same search as the editor cache, incoming references with one referencer scan per batch.
+ * Json output is JSON lines, one reference per line with its kind & property paths, written as each batch of actors is searched.
+ * Binary output is an FCrvGraphFile, which holds the whole graph in memory until it is written.
+ * -HeadersOnly reads actor references from the map's __ExternalActors__ package headers instead of loading it, see FCrvExternalActorScanner.
+ */
+UCLASS()
+class UCrvExportGraphCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UCrvExportGraphCommandlet();
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,308 @@
+#include "CrvExternalActorScanner.h"
+
+#include "CtrlReferenceVisualizer.h"
+
+#include "Async/ParallelFor.h"
+
+#include "Engine/Level.h"
+
+#include "HAL/FileManager.h"
+
+#include "Misc/PackageName.h"
+
+#include "Serialization/ArchiveProxy.h"
+
+#include "UObject/ObjectResource.h"
+#include "UObject/PackageFileSummary.h"
+
+namespace CtrlRefViz::ExternalActors
+{
+	// Reads names as indices into a package's name table, like the linker does
+	class FNameTableArchive : public FArchiveProxy
+	{
+	public:
+		FNameTableArchive(FArchive& InInnerArchive, const TArray<FName>& InNames)
+			: FArchiveProxy(InInnerArchive),
+			  Names(InNames) {}
+
+		virtual FArchive& operator<<(FName& Name) override
+		{
+			int32 Index = 0;
+			int32 Number = 0;
+			InnerArchive << Index << Number;
+			if (!Names.IsValidIndex(Index))
+			{
+				SetError();
+				Name = NAME_None;
+				return *this;
+			}
+			Name = FName(Names[Index], Number);
+			return *this;
+		}
+
+	private:
+		const TArray<FName>& Names;
+	};
+
+	struct FPackageRefs
+	{
+		FName ActorName;
+		TArray<FName> HardRefs;
+		TArray<FName> SoftRefs;
+		bool bRead = false;
+	};
+
+	static const FObjectImport* GetOuterImport(const TArray<FObjectImport>& Imports, const FObjectImport& Import)
+	{
+		if (!Import.OuterIndex.IsImport()) { return nullptr; }
+		const int32 OuterIndex = Import.OuterIndex.ToImport();
+		return Imports.IsValidIndex(OuterIndex) ? &Imports[OuterIndex] : nullptr;
+	}
+
+	// Level -> World -> map package
+	static bool IsMapLevel(const TArray<FObjectImport>& Imports, const FObjectImport& Import, const FName MapPackageName)
+	{
+		if (Import.ObjectName != NAME_PersistentLevel || Import.ClassName != NAME_Level) { return false; }
+		const auto World = GetOuterImport(Imports, Import);
+		const auto Package = World ? GetOuterImport(Imports, *World) : nullptr;
+		return Package && Package->ObjectName == MapPackageName;
+	}
+
+	// Actor in the map's persistent level that the import at Index is or is inside of, NAME_None if it's outside the level
+	static FName FindActorImport(const TArray<FObjectImport>& Imports, const FName MapPackageName, const int32 Index)
+	{
+		const FObjectImport* Import = &Imports[Index];
+		// outer chains can't be longer than the import table
+		for (int32 Depth = 0; Depth < Imports.Num() && Import; ++Depth)
+		{
+			const auto Outer = GetOuterImport(Imports, *Import);
+			if (Outer && IsMapLevel(Imports, *Outer, MapPackageName))
+			{
+				return Import->ObjectName;
+			}
+			Import = Outer;
+		}
+		return NAME_None;
+	}
+
+	// Actor named by a soft path into the map, e.g. PersistentLevel.MyActor.MyComponent
+	static FName FindActorInSubPath(const FString& SubPath)
+	{
+		static const FString LevelPrefix = TEXT("PersistentLevel.");
+		if (!SubPath.StartsWith(LevelPrefix, ESearchCase::CaseSensitive)) { return NAME_None; }
+		FString ActorName = SubPath.Mid(LevelPrefix.Len());
+		int32 Separator = INDEX_NONE;
+		if (ActorName.FindChar(TEXT('.'), Separator))
+		{
+			ActorName.LeftInline(Separator);
+		}
+		return FName(ActorName);
+	}
+
+	static FPackageRefs ReadPackage(const FString& Filename, const FName MapPackageName)
+	{
+		FPackageRefs Refs;
+		const TUniquePtr<FArchive> FileReader(IFileManager::Get().CreateFileReader(*Filename, FILEREAD_Silent));
+		if (!FileReader) { return Refs; }
+
+		FPackageFileSummary Summary;
+		*FileReader << Summary;
+		// cooked & unversioned packages can't be read without their engine's versions
+		if (FileReader->IsError() || Summary.Tag != PACKAGE_FILE_TAG || Summary.bUnversioned) { return Refs; }
+		FileReader->SetUEVer(Summary.GetFileVersionUE());
+		FileReader->SetLicenseeUEVer(Summary.GetFileVersionLicenseeUE());
+		FileReader->SetEngineVer(Summary.SavedByEngineVersion);
+		FileReader->SetCustomVersions(Summary.GetCustomVersionContainer());
+		FileReader->SetFilterEditorOnly((Summary.GetPackageFlags() & PKG_FilterEditorOnly) != 0);
+
+		TArray<FName> Names;
+		Names.Reserve(Summary.NameCount);
+		FileReader->Seek(Summary.NameOffset);
+		for (int32 Index = 0; Index < Summary.NameCount && !FileReader->IsError(); ++Index)
+		{
+			FNameEntrySerialized NameEntry(ENAME_LinkerConstructor);
+			*FileReader << NameEntry;
+			Names.Add(FName(NameEntry));
+		}
+
+		FNameTableArchive Reader(*FileReader, Names);
+		TArray<FObjectImport> Imports;
+		Imports.SetNum(Summary.ImportCount);
+		Reader.Seek(Summary.ImportOffset);
+		for (auto& Import : Imports)
+		{
+			Reader << Import;
+		}
+		if (Reader.IsError()) { return Refs; }
+
+		// the actor is the export whose outer is the imported persistent level
+		Reader.Seek(Summary.ExportOffset);
+		for (int32 Index = 0; Index < Summary.ExportCount && Refs.ActorName.IsNone(); ++Index)
+		{
+			FObjectExport Export;
+			Reader << Export;
+			if (Reader.IsError()) { return Refs; }
+			if (!Export.OuterIndex.IsImport()) { continue; }
+			const int32 OuterIndex = Export.OuterIndex.ToImport();
+			if (Imports.IsValidIndex(OuterIndex) && IsMapLevel(Imports, Imports[OuterIndex], MapPackageName))
+			{
+				Refs.ActorName = Export.ObjectName;
+			}
+		}
+		if (Refs.ActorName.IsNone()) { return Refs; }
+
+		for (int32 Index = 0; Index < Imports.Num(); ++Index)
+		{
+			const auto ActorName = FindActorImport(Imports, MapPackageName, Index);
+			if (!ActorName.IsNone() && ActorName != Refs.ActorName)
+			{
+				Refs.HardRefs.AddUnique(ActorName);
+			}
+		}
+
+#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 1
+		Reader.Seek(Summary.SoftObjectPathsOffset);
+		for (int32 Index = 0; Index < Summary.SoftObjectPathsCount && !Reader.IsError(); ++Index)
+		{
+			FSoftObjectPath Path;
+			Path.SerializePathWithoutFixup(Reader);
+			if (Path.GetLongPackageFName() != MapPackageName) { continue; }
+			const auto ActorName = FindActorInSubPath(Path.GetSubPathString());
+			if (!ActorName.IsNone() && ActorName != Refs.ActorName && !Refs.HardRefs.Contains(ActorName))
+			{
+				Refs.SoftRefs.AddUnique(ActorName);
+			}
+		}
+#endif
+		Refs.bRead = !Reader.IsError();
+		return Refs;
+	}
+}
+
+bool FCrvExternalActorScanner::Scan(const FString& InMapPackageName)
+{
+	using namespace CtrlRefViz::ExternalActors;
+
+	Reset();
+	MapPackageName = InMapPackageName;
+	FString Directory;
+	if (!FPackageName::TryConvertLongPackageNameToFilename(ULevel::GetExternalActorsPath(MapPackageName), Directory)) { return false; }
+	if (!IFileManager::Get().DirectoryExists(*Directory)) { return false; }
+
+	const double StartTime = FPlatformTime::Seconds();
+	TArray<FString> Filenames;
+	IFileManager::Get().FindFilesRecursive(Filenames, *Directory, *(TEXT("*") + FPackageName::GetAssetPackageExtension()), true, false);
+	// sorted so actor order is the same across runs
+	Filenames.Sort();
+
+	TArray<FPackageRefs> PackageRefs;
+	PackageRefs.SetNum(Filenames.Num());
+	const FName MapPackageFName(MapPackageName);
+	ParallelFor(Filenames.Num(), [&PackageRefs, &Filenames, MapPackageFName](const int32 Index)
+	{
+		PackageRefs[Index] = ReadPackage(Filenames[Index], MapPackageFName);
+	});
+
+	TMap<FName, int32> ActorIds;
+	for (int32 Index = 0; Index < Filenames.Num(); ++Index)
+	{
+		if (!PackageRefs[Index].bRead)
+		{
+			++UnreadPackages;
+			continue;
+		}
+		ActorIds.Add(PackageRefs[Index].ActorName, Actors.Add({PackageRefs[Index].ActorName, Filenames[Index]}));
+	}
+
+	// count, then fill each direction's edges
+	OutOffsets.SetNumZeroed(Actors.Num() + 1);
+	InOffsets.SetNumZeroed(Actors.Num() + 1);
+	struct FEdge
+	{
+		int32 Source;
+		int32 Target;
+		bool bSoft;
+	};
+	TArray<FEdge> Edges;
+	for (const auto& Refs : PackageRefs)
+	{
+		const auto Source = Refs.bRead ? ActorIds.Find(Refs.ActorName) : nullptr;
+		if (!Source) { continue; }
+		for (const bool bSoft : {false, true})
+		{
+			for (const auto& Name : bSoft ? Refs.SoftRefs : Refs.HardRefs)
+			{
+				if (const auto Target = ActorIds.Find(Name))
+				{
+					Edges.Add({*Source, *Target, bSoft});
+					++OutOffsets[*Source + 1];
+					++InOffsets[*Target + 1];
+				}
+			}
+		}
+	}
+	for (int32 Index = 0; Index < Actors.Num(); ++Index)
+	{
+		OutOffsets[Index + 1] += OutOffsets[Index];
+		InOffsets[Index + 1] += InOffsets[Index];
+	}
+	OutEdges.SetNumUninitialized(Edges.Num());
+	OutEdgesSoft.SetNumUninitialized(Edges.Num());
+	InEdges.SetNumUninitialized(Edges.Num());
+	TArray<int32> OutNext(OutOffsets.GetData(), Actors.Num());
+	TArray<int32> InNext(InOffsets.GetData(), Actors.Num());
+	for (const auto& [Source, Target, bSoft] : Edges)
+	{
+		OutEdgesSoft[OutNext[Source]] = bSoft;
+		OutEdges[OutNext[Source]++] = Target;
+		InEdges[InNext[Target]++] = Source;
+	}
+	UE_LOG(
+		LogCrv,
+		Display,
+		TEXT("Scanned %d external actors of %s: %d references in %.2fs, %d packages unread"),
+		Actors.Num(),
+		*MapPackageName,
+		Edges.Num(),
+		FPlatformTime::Seconds() - StartTime,
+		UnreadPackages
+	);
+	return true;
+}
+
+void FCrvExternalActorScanner::Reset()
+{
+	MapPackageName.Reset();
+	Actors.Reset();
+	OutOffsets.Reset();
+	OutEdges.Reset();
+	OutEdgesSoft.Reset();
+	InOffsets.Reset();
+	InEdges.Reset();
+	UnreadPackages = 0;
+}
+
+FString FCrvExternalActorScanner::GetActorPath(const int32 Index) const
+{
+	return FString::Printf(TEXT("%s.%s:PersistentLevel.%s"), *MapPackageName, *FPackageName::GetShortName(MapPackageName), *Actors[Index].Name.ToString());
+}
+
+TConstArrayView<int32> FCrvExternalActorScanner::GetReferences(const int32 Index, const ECrvDirection Direction) const
+{
+	const bool bOutgoing = Direction == ECrvDirection::Outgoing;
+	const auto& Offsets = bOutgoing ? OutOffsets : InOffsets;
+	const auto& Edges = bOutgoing ? OutEdges : InEdges;
+	return MakeArrayView(Edges.GetData() + Offsets[Index], Offsets[Index + 1] - Offsets[Index]);
+}
+
+bool FCrvExternalActorScanner::IsSoftReference(const int32 Source, const int32 Target) const
+{
+	for (int32 Edge = OutOffsets[Source]; Edge < OutOffsets[Source + 1]; ++Edge)
+	{
+		if (OutEdges[Edge] == Target)
+		{
+			return OutEdgesSoft[Edge];
+		}
+	}
+	return false;
+}
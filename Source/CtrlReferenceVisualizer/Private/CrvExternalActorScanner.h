@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CrvSettings.h"
+
+struct FCrvScannedActor
+{
+	// name in the map's persistent level
+	FName Name;
+	FString PackageFilename;
+};
+
+/**
+ * Actor references of a one-file-per-actor map, read from the import & soft object path tables of its __ExternalActors__ packages.
+ * Packages are never loaded, their headers are read in parallel, so this is a cheap pre-pass for CI & reports.
+ * Only references between actors of the same map are kept, edges are stored compressed by source actor like FCrvActorDescGraph.
+ */
+class FCrvExternalActorScanner
+{
+public:
+	// False if the map has no external actors folder
+	bool Scan(const FString& MapPackageName);
+	void Reset();
+
+	int32 Num() const { return Actors.Num(); }
+	int32 NumEdges() const { return OutEdges.Num(); }
+	const FCrvScannedActor& GetActor(int32 Index) const { return Actors[Index]; }
+	// object path of the actor, e.g. /Game/Maps/MyMap.MyMap:PersistentLevel.MyActor
+	FString GetActorPath(int32 Index) const;
+	// Actors referenced by (Outgoing) or referencing (Incoming) the actor at Index
+	TConstArrayView<int32> GetReferences(int32 Index, ECrvDirection Direction) const;
+	// Whether Source only references Target through a soft object path
+	bool IsSoftReference(int32 Source, int32 Target) const;
+	int32 NumUnreadPackages() const { return UnreadPackages; }
+
+private:
+	FString MapPackageName;
+	TArray<FCrvScannedActor> Actors;
+	// edges of actor N are Edges[Offsets[N]..Offsets[N + 1]]
+	TArray<int32> OutOffsets;
+	TArray<int32> OutEdges;
+	TArray<bool> OutEdgesSoft;
+	TArray<int32> InOffsets;
+	TArray<int32> InEdges;
+	int32 UnreadPackages = 0;
+};
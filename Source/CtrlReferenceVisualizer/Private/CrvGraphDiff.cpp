@@ -0,0 +1,206 @@
+#include "CrvGraphDiff.h"
+
+#include "CrvGraphFile.h"
+#include "CrvNameIndex.h"
+#include "CtrlReferenceVisualizer.h"
+
+#include "Algo/Count.h"
+
+namespace CtrlRefViz::GraphDiff
+{
+	static FString MakeKey(const FGuid& ActorGuid, const FString& PathName)
+	{
+		return ActorGuid.IsValid() ? ActorGuid.ToString() : PathName;
+	}
+
+	// direction in the top bit, then root & leaf ranks, so sorted edges group by direction & root
+	static uint64 PackEdge(const ECrvDirection Direction, const uint32 Root, const uint32 Leaf)
+	{
+		return static_cast<uint64>(Direction) << 63 | static_cast<uint64>(Root) << 32 | Leaf;
+	}
+
+	static TArray<uint64> RankEdges(const FCrvGraphSnapshot& Snapshot, const TArray<uint32>& Ranks)
+	{
+		TArray<uint64> Edges;
+		Edges.Reserve(Snapshot.Edges.Num());
+		for (const auto& Edge : Snapshot.Edges)
+		{
+			Edges.Add(PackEdge(Edge.Direction, Ranks[Edge.Root], Ranks[Edge.Leaf]));
+		}
+		Edges.Sort();
+		return Edges;
+	}
+}
+
+FCrvGraphSnapshot FCrvGraphSnapshot::FromFile(const FCrvGraphFile& File)
+{
+	FCrvGraphSnapshot Snapshot;
+	Snapshot.Nodes.Reserve(File.NumNodes());
+	for (int32 Index = 0; Index < File.NumNodes(); ++Index)
+	{
+		const auto& Node = File.GetNode(Index);
+		auto PathName = File.GetPathName(Index);
+		auto Key = CtrlRefViz::GraphDiff::MakeKey(Node.ActorGuid, PathName);
+		Snapshot.Nodes.Add({MoveTemp(Key), MoveTemp(PathName), FString(File.GetName(Node.Label)), Node.bIsRoot != 0});
+	}
+	Snapshot.Edges.Reserve(File.NumEdges(ECrvDirection::Outgoing) + File.NumEdges(ECrvDirection::Incoming));
+	for (const auto Direction : {ECrvDirection::Outgoing, ECrvDirection::Incoming})
+	{
+		for (int32 Index = 0; Index < File.NumNodes(); ++Index)
+		{
+			for (const uint32 Leaf : File.GetEdges(Index, Direction))
+			{
+				Snapshot.Edges.Add({Direction, Index, static_cast<int32>(Leaf)});
+			}
+		}
+	}
+	return Snapshot;
+}
+
+FCrvGraphSnapshot FCrvGraphSnapshot::FromGraphs(const FCrvObjectGraph& Outgoing, const FCrvObjectGraph& Incoming)
+{
+	FCrvGraphSnapshot Snapshot;
+	TMap<UObject*, int32> NodeIds;
+	const auto GetNodeId = [&Snapshot, &NodeIds](UObject* Object)
+	{
+		if (const auto Found = NodeIds.Find(Object)) { return *Found; }
+		const auto Actor = Cast<AActor>(Object);
+		auto PathName = Object->GetPathName();
+		auto Key = CtrlRefViz::GraphDiff::MakeKey(Actor ? Actor->GetActorInstanceGuid() : FGuid(), PathName);
+		return NodeIds.Add(Object, Snapshot.Nodes.Add({MoveTemp(Key), MoveTemp(PathName), FCrvNameIndex::GetLabel(Object)}));
+	};
+	for (const auto Direction : {ECrvDirection::Outgoing, ECrvDirection::Incoming})
+	{
+		for (const auto& [Root, Leaves] : Direction == ECrvDirection::Outgoing ? Outgoing : Incoming)
+		{
+			if (!IsValid(Root)) { continue; }
+			const int32 RootId = GetNodeId(Root);
+			Snapshot.Nodes[RootId].bIsRoot = true;
+			for (const auto Leaf : Leaves)
+			{
+				if (!IsValid(Leaf)) { continue; }
+				Snapshot.Edges.Add({Direction, RootId, GetNodeId(Leaf)});
+			}
+		}
+	}
+	return Snapshot;
+}
+
+FCrvGraphDiff FCrvGraphDiff::Compare(const FCrvGraphSnapshot& Old, const FCrvGraphSnapshot& New, const bool bOnlySharedRoots)
+{
+	using namespace CtrlRefViz::GraphDiff;
+
+	// rank the keys of both snapshots together, equal keys share a rank
+	TArray<TPair<const FString*, int32>> Keys;
+	Keys.Reserve(Old.Nodes.Num() + New.Nodes.Num());
+	for (int32 Index = 0; Index < Old.Nodes.Num(); ++Index)
+	{
+		Keys.Emplace(&Old.Nodes[Index].Key, Index);
+	}
+	for (int32 Index = 0; Index < New.Nodes.Num(); ++Index)
+	{
+		// new nodes are stored after the old ones
+		Keys.Emplace(&New.Nodes[Index].Key, Old.Nodes.Num() + Index);
+	}
+	Keys.Sort([](const auto& A, const auto& B) { return A.Key->Compare(*B.Key, ESearchCase::CaseSensitive) < 0; });
+
+	TArray<uint32> OldRanks;
+	TArray<uint32> NewRanks;
+	OldRanks.SetNumZeroed(Old.Nodes.Num());
+	NewRanks.SetNumZeroed(New.Nodes.Num());
+	// node to describe each rank with, preferring the new snapshot
+	TArray<const FCrvGraphSnapshot::FNode*> RankNodes;
+	RankNodes.Reserve(Keys.Num());
+	TBitArray<> OldRoots;
+	TBitArray<> NewRoots;
+	for (int32 Index = 0; Index < Keys.Num(); ++Index)
+	{
+		const auto& [Key, Id] = Keys[Index];
+		if (Index == 0 || !Keys[Index - 1].Key->Equals(*Key, ESearchCase::CaseSensitive))
+		{
+			RankNodes.Add(nullptr);
+			OldRoots.Add(false);
+			NewRoots.Add(false);
+		}
+		const uint32 Rank = RankNodes.Num() - 1;
+		const bool bIsNew = Id >= Old.Nodes.Num();
+		if (bIsNew)
+		{
+			NewRanks[Id - Old.Nodes.Num()] = Rank;
+			RankNodes[Rank] = &New.Nodes[Id - Old.Nodes.Num()];
+			NewRoots[Rank] = NewRoots[Rank] || New.Nodes[Id - Old.Nodes.Num()].bIsRoot;
+		}
+		else
+		{
+			OldRanks[Id] = Rank;
+			OldRoots[Rank] = OldRoots[Rank] || Old.Nodes[Id].bIsRoot;
+			if (!RankNodes[Rank])
+			{
+				RankNodes[Rank] = &Old.Nodes[Id];
+			}
+		}
+	}
+
+	auto OldEdges = RankEdges(Old, OldRanks);
+	auto NewEdges = RankEdges(New, NewRanks);
+	if (bOnlySharedRoots)
+	{
+		const auto IsNotShared = [&OldRoots, &NewRoots](const uint64 Edge)
+		{
+			const int32 Root = (Edge >> 32) & MAX_int32;
+			return !OldRoots[Root] || !NewRoots[Root];
+		};
+		// removal keeps the order, edges stay sorted
+		OldEdges.RemoveAll(IsNotShared);
+		NewEdges.RemoveAll(IsNotShared);
+	}
+
+	FCrvGraphDiff Diff;
+	const auto AddChange = [&Diff, &RankNodes](const uint64 Edge, const bool bAdded)
+	{
+		const auto Root = RankNodes[(Edge >> 32) & MAX_int32];
+		const auto Leaf = RankNodes[Edge & MAX_uint32];
+		Diff.Changes.Add({static_cast<ECrvDirection>(Edge >> 63), bAdded, Root->PathName, Root->Label, Leaf->PathName, Leaf->Label});
+	};
+	int32 OldIndex = 0;
+	int32 NewIndex = 0;
+	while (OldIndex < OldEdges.Num() || NewIndex < NewEdges.Num())
+	{
+		if (NewIndex == NewEdges.Num() || (OldIndex < OldEdges.Num() && OldEdges[OldIndex] < NewEdges[NewIndex]))
+		{
+			AddChange(OldEdges[OldIndex++], false);
+		}
+		else if (OldIndex == OldEdges.Num() || NewEdges[NewIndex] < OldEdges[OldIndex])
+		{
+			AddChange(NewEdges[NewIndex++], true);
+		}
+		else
+		{
+			++OldIndex;
+			++NewIndex;
+		}
+	}
+	return Diff;
+}
+
+int32 FCrvGraphDiff::NumAdded() const
+{
+	return Algo::CountIf(Changes, [](const FCrvGraphDiffEdge& Change) { return Change.bAdded; });
+}
+
+void FCrvGraphDiff::Log() const
+{
+	UE_LOG(LogCrv, Display, TEXT("Reference graph diff: %d added, %d removed"), NumAdded(), NumRemoved());
+	for (const auto& Change : Changes)
+	{
+		const bool bOutgoing = Change.Direction == ECrvDirection::Outgoing;
+		UE_LOG(
+			LogCrv,
+			Display,
+			TEXT("\t%s %s -> %s"),
+			Change.bAdded ? TEXT("+") : TEXT("-"),
+			bOutgoing ? *Change.RootLabel : *Change.LeafLabel,
+			bOutgoing ? *Change.LeafLabel : *Change.RootLabel
+		);
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CrvSettings.h"
+#include "CrvUtils.h"
+
+class FCrvGraphFile;
+
+/**
+ * Nodes & edges of a reference graph in a form that can be compared across sessions.
+ * Actors are keyed by actor instance guid so renamed or moved actors still match, other objects by path name.
+ */
+struct FCrvGraphSnapshot
+{
+	struct FNode
+	{
+		FString Key;
+		FString PathName;
+		FString Label;
+		// searched from, rather than only found as a leaf
+		bool bIsRoot = false;
+	};
+
+	struct FEdge
+	{
+		ECrvDirection Direction;
+		int32 Root;
+		int32 Leaf;
+	};
+
+	TArray<FNode> Nodes;
+	TArray<FEdge> Edges;
+
+	static FCrvGraphSnapshot FromFile(const FCrvGraphFile& File);
+	static FCrvGraphSnapshot FromGraphs(const FCrvObjectGraph& Outgoing, const FCrvObjectGraph& Incoming);
+};
+
+struct FCrvGraphDiffEdge
+{
+	ECrvDirection Direction;
+	bool bAdded = false;
+	// from the new snapshot if the object is in it, otherwise the old one
+	FString RootPath;
+	FString RootLabel;
+	FString LeafPath;
+	FString LeafLabel;
+};
+
+/**
+ * References added & removed between two graph snapshots.
+ * Node keys of both snapshots are ranked together, then edges are compared as sorted rank triples in one pass.
+ * Only the final pass is linear: ranking sorts all N keys with string compares & both edge arrays are sorted again,
+ * so each call costs O((N + E) log(N + E)) even when the snapshots come from files whose rows are already sorted.
+ */
+struct FCrvGraphDiff
+{
+	TArray<FCrvGraphDiffEdge> Changes;
+
+	// bOnlySharedRoots skips edges of roots missing from either snapshot, e.g. when one only holds the selected roots
+	static FCrvGraphDiff Compare(const FCrvGraphSnapshot& Old, const FCrvGraphSnapshot& New, bool bOnlySharedRoots = false);
+
+	int32 NumAdded() const;
+	int32 NumRemoved() const { return Changes.Num() - NumAdded(); }
+	void Log() const;
+};
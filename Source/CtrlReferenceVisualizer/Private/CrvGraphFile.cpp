@@ -0,0 +1,322 @@
+#include "CrvGraphFile.h"
+
+#include "CrvNameIndex.h"
+#include "CtrlReferenceVisualizer.h"
+#include "ReferenceVisualizerComponent.h"
+
+#include "Engine/World.h"
+
+#include "Async/MappedFileHandle.h"
+
+#include "HAL/PlatformFileManager.h"
+
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+
+namespace CtrlRefViz::GraphFile
+{
+	constexpr uint64 SectionAlignment = 8;
+
+	static uint64 AppendSection(TArray64<uint8>& Out, const void* Section, const uint64 NumBytes)
+	{
+		Out.SetNumZeroed(Align(Out.Num(), SectionAlignment));
+		const uint64 Offset = Out.Num();
+		Out.Append(static_cast<const uint8*>(Section), NumBytes);
+		return Offset;
+	}
+
+	template <typename T>
+	static uint64 AppendSection(TArray64<uint8>& Out, const TArray<T>& Section)
+	{
+		return AppendSection(Out, Section.GetData(), Section.Num() * sizeof(T));
+	}
+
+	static bool IsSectionValid(const uint64 Offset, const uint64 NumBytes, const uint64 FileSize)
+	{
+		return Offset % SectionAlignment == 0 && Offset <= FileSize && NumBytes <= FileSize - Offset;
+	}
+
+	// Offsets start at 0, never decrease & end at NumValues
+	static bool AreOffsetsValid(const uint32* Offsets, const uint32 NumRows, const uint64 NumValues)
+	{
+		if (Offsets[0] != 0 || Offsets[NumRows] != NumValues) { return false; }
+		for (uint32 Row = 0; Row < NumRows; ++Row)
+		{
+			if (Offsets[Row] > Offsets[Row + 1]) { return false; }
+		}
+		return true;
+	}
+
+	static bool AreIndicesValid(const uint32* Indices, const uint32 NumIndices, const uint32 NumValues)
+	{
+		for (uint32 Index = 0; Index < NumIndices; ++Index)
+		{
+			if (Indices[Index] >= NumValues) { return false; }
+		}
+		return true;
+	}
+
+	// Interns names into the name table
+	class FNameTableBuilder
+	{
+	public:
+		uint32 AddName(const FString& Name)
+		{
+			if (const auto Found = NameIds.Find(Name)) { return *Found; }
+			const uint32 Id = NameOffsets.Num();
+			NameIds.Add(Name, Id);
+			NameOffsets.Add(NameChars.Num());
+			const FTCHARToUTF8 Utf8(*Name);
+			NameChars.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+			return Id;
+		}
+
+		TMap<FString, uint32> NameIds;
+		TArray<uint32> NameOffsets;
+		TArray<uint8> NameChars;
+	};
+
+	static void BuildRows(const FCrvObjectGraph& Graph, const TMap<UObject*, int32>& NodeIds, TArray<uint32>& OutOffsets, TArray<uint32>& OutEdges)
+	{
+		TArray<TArray<uint32>> Rows;
+		Rows.SetNum(NodeIds.Num());
+		for (const auto& [Root, Leaves] : Graph)
+		{
+			const auto RootId = NodeIds.Find(Root);
+			if (!RootId) { continue; }
+			for (const auto Leaf : Leaves)
+			{
+				if (const auto LeafId = NodeIds.Find(Leaf))
+				{
+					Rows[*RootId].Add(*LeafId);
+				}
+			}
+		}
+		OutOffsets.Reset(Rows.Num() + 1);
+		OutOffsets.Add(0);
+		for (auto& Row : Rows)
+		{
+			Row.Sort();
+			OutEdges.Append(Row);
+			OutOffsets.Add(OutEdges.Num());
+		}
+	}
+}
+
+FCrvGraphFile::~FCrvGraphFile()
+{
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+}
+
+TArray64<uint8> FCrvGraphFile::Write(const FCrvObjectGraph& Outgoing, const FCrvObjectGraph& Incoming)
+{
+	using namespace CtrlRefViz::GraphFile;
+
+	// nodes sorted by path so files of the same level can be compared edge by edge
+	TSet<UObject*> Roots;
+	TSet<UObject*> Objects;
+	for (const auto Graph : {&Outgoing, &Incoming})
+	{
+		for (const auto& [Root, Leaves] : *Graph)
+		{
+			if (!IsValid(Root)) { continue; }
+			Roots.Add(Root);
+			Objects.Add(Root);
+			for (const auto Leaf : Leaves)
+			{
+				if (IsValid(Leaf))
+				{
+					Objects.Add(Leaf);
+				}
+			}
+		}
+	}
+	TArray<TPair<FString, UObject*>> SortedObjects;
+	SortedObjects.Reserve(Objects.Num());
+	for (const auto Object : Objects)
+	{
+		SortedObjects.Emplace(Object->GetPathName(), Object);
+	}
+	SortedObjects.Sort([](const auto& A, const auto& B) { return A.Key.Compare(B.Key, ESearchCase::CaseSensitive) < 0; });
+
+	FNameTableBuilder Builder;
+	TArray<FCrvGraphFileNode> Nodes;
+	TMap<UObject*, int32> NodeIds;
+	Nodes.Reserve(SortedObjects.Num());
+	NodeIds.Reserve(SortedObjects.Num());
+	for (const auto& [PathName, Object] : SortedObjects)
+	{
+		FCrvGraphFileNode Node;
+		if (const auto Actor = Cast<AActor>(Object))
+		{
+			Node.ActorGuid = Actor->GetActorInstanceGuid();
+		}
+		Node.PathName = Builder.AddName(PathName);
+		Node.Label = Builder.AddName(FCrvNameIndex::GetLabel(Object));
+		Node.ClassPath = Builder.AddName(Object->GetClass()->GetPathName());
+		Node.Kind = static_cast<uint8>(UReferenceVisualizerComponent::GetObjectKind(Object->GetClass()));
+		Node.bIsRoot = Roots.Contains(Object);
+		NodeIds.Add(Object, Nodes.Add(Node));
+	}
+	Builder.NameOffsets.Add(Builder.NameChars.Num());
+
+	TArray<uint32> OutOffsets;
+	TArray<uint32> OutEdges;
+	TArray<uint32> InOffsets;
+	TArray<uint32> InEdges;
+	BuildRows(Outgoing, NodeIds, OutOffsets, OutEdges);
+	BuildRows(Incoming, NodeIds, InOffsets, InEdges);
+
+	FCrvGraphFileHeader Header;
+	Header.NumNames = Builder.NameOffsets.Num() - 1;
+	Header.NumNodes = Nodes.Num();
+	Header.NumOutEdges = OutEdges.Num();
+	Header.NumInEdges = InEdges.Num();
+
+	TArray64<uint8> Out;
+	AppendSection(Out, &Header, sizeof(Header));
+	Header.NameOffsets = AppendSection(Out, Builder.NameOffsets);
+	Header.NameChars = AppendSection(Out, Builder.NameChars);
+	Header.Nodes = AppendSection(Out, Nodes);
+	Header.OutOffsets = AppendSection(Out, OutOffsets);
+	Header.OutEdges = AppendSection(Out, OutEdges);
+	Header.InOffsets = AppendSection(Out, InOffsets);
+	Header.InEdges = AppendSection(Out, InEdges);
+	Header.FileSize = Out.Num();
+	FMemory::Memcpy(Out.GetData(), &Header, sizeof(Header));
+	return Out;
+}
+
+bool FCrvGraphFile::Save(const FString& Path, const FCrvObjectGraph& Outgoing, const FCrvObjectGraph& Incoming)
+{
+	const auto Bytes = Write(Outgoing, Incoming);
+	if (!FFileHelper::SaveArrayToFile(Bytes, *Path))
+	{
+		UE_LOG(LogCrv, Warning, TEXT("Could not write reference graph %s"), *Path);
+		return false;
+	}
+	UE_CLOG(FCrvModule::IsDebugEnabled(), LogCrv, Log, TEXT("Saved reference graph %s: %lld bytes"), *Path, Bytes.Num());
+	return true;
+}
+
+TUniquePtr<FCrvGraphFile> FCrvGraphFile::Open(const FString& Path)
+{
+	TUniquePtr<FCrvGraphFile> File(new FCrvGraphFile());
+	auto& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	File->MappedHandle.Reset(PlatformFile.OpenMapped(*Path));
+	if (File->MappedHandle)
+	{
+		File->MappedRegion.Reset(File->MappedHandle->MapRegion(0, File->MappedHandle->GetFileSize()));
+	}
+	if (File->MappedRegion)
+	{
+		if (!File->Init(File->MappedRegion->GetMappedPtr(), File->MappedRegion->GetMappedSize())) { return nullptr; }
+	}
+	else
+	{
+		if (!FFileHelper::LoadFileToArray(File->Loaded, *Path, FILEREAD_Silent)) { return nullptr; }
+		if (!File->Init(File->Loaded.GetData(), File->Loaded.Num())) { return nullptr; }
+	}
+	return File;
+}
+
+bool FCrvGraphFile::Init(const uint8* InData, const int64 InSize)
+{
+	using namespace CtrlRefViz::GraphFile;
+
+	Data = InData;
+	Size = InSize;
+	if (Size < static_cast<int64>(sizeof(FCrvGraphFileHeader))) { return false; }
+	Header = GetSection<FCrvGraphFileHeader>(0);
+	if (Header->Magic != FCrvGraphFileHeader::MagicValue)
+	{
+		UE_LOG(LogCrv, Warning, TEXT("Not a reference graph file"));
+		return false;
+	}
+	if (Header->Version != FCrvGraphFileHeader::CurrentVersion)
+	{
+		UE_LOG(LogCrv, Warning, TEXT("Unsupported reference graph file version %u"), Header->Version);
+		return false;
+	}
+	const uint64 FileSize = Size;
+	// every index is checked once here, so lookups can read the file without bounds checks
+	bool bValid = Header->FileSize == FileSize
+		&& Header->NumNodes <= static_cast<uint32>(MAX_int32)
+		&& Header->NumNames < MAX_uint32
+		&& IsSectionValid(Header->NameOffsets, (Header->NumNames + 1ull) * sizeof(uint32), FileSize)
+		&& IsSectionValid(Header->Nodes, Header->NumNodes * static_cast<uint64>(sizeof(FCrvGraphFileNode)), FileSize)
+		&& IsSectionValid(Header->OutOffsets, (Header->NumNodes + 1ull) * sizeof(uint32), FileSize)
+		&& IsSectionValid(Header->OutEdges, Header->NumOutEdges * static_cast<uint64>(sizeof(uint32)), FileSize)
+		&& IsSectionValid(Header->InOffsets, (Header->NumNodes + 1ull) * sizeof(uint32), FileSize)
+		&& IsSectionValid(Header->InEdges, Header->NumInEdges * static_cast<uint64>(sizeof(uint32)), FileSize)
+		&& IsSectionValid(Header->NameChars, GetSection<uint32>(Header->NameOffsets)[Header->NumNames], FileSize)
+		&& AreOffsetsValid(GetSection<uint32>(Header->NameOffsets), Header->NumNames, GetSection<uint32>(Header->NameOffsets)[Header->NumNames])
+		&& AreOffsetsValid(GetSection<uint32>(Header->OutOffsets), Header->NumNodes, Header->NumOutEdges)
+		&& AreOffsetsValid(GetSection<uint32>(Header->InOffsets), Header->NumNodes, Header->NumInEdges)
+		&& AreIndicesValid(GetSection<uint32>(Header->OutEdges), Header->NumOutEdges, Header->NumNodes)
+		&& AreIndicesValid(GetSection<uint32>(Header->InEdges), Header->NumInEdges, Header->NumNodes);
+	const auto Nodes = GetSection<FCrvGraphFileNode>(Header->Nodes);
+	for (uint32 Index = 0; bValid && Index < Header->NumNodes; ++Index)
+	{
+		const auto& Node = Nodes[Index];
+		bValid = Node.PathName < Header->NumNames && Node.Label < Header->NumNames && Node.ClassPath < Header->NumNames;
+	}
+	UE_CLOG(!bValid, LogCrv, Warning, TEXT("Reference graph file is truncated or corrupt"));
+	return bValid;
+}
+
+int32 FCrvGraphFile::NumEdges(const ECrvDirection Direction) const
+{
+	return Direction == ECrvDirection::Outgoing ? Header->NumOutEdges : Header->NumInEdges;
+}
+
+const FCrvGraphFileNode& FCrvGraphFile::GetNode(const int32 Index) const
+{
+	check(Index >= 0 && static_cast<uint32>(Index) < Header->NumNodes);
+	return GetSection<FCrvGraphFileNode>(Header->Nodes)[Index];
+}
+
+FUtf8StringView FCrvGraphFile::GetName(const uint32 NameIndex) const
+{
+	check(NameIndex < Header->NumNames);
+	const auto Offsets = GetSection<uint32>(Header->NameOffsets);
+	return FUtf8StringView(GetSection<UTF8CHAR>(Header->NameChars) + Offsets[NameIndex], Offsets[NameIndex + 1] - Offsets[NameIndex]);
+}
+
+TConstArrayView<uint32> FCrvGraphFile::GetEdges(const int32 Index, const ECrvDirection Direction) const
+{
+	check(Index >= 0 && static_cast<uint32>(Index) < Header->NumNodes);
+	const bool bOutgoing = Direction == ECrvDirection::Outgoing;
+	const auto Offsets = GetSection<uint32>(bOutgoing ? Header->OutOffsets : Header->InOffsets);
+	const auto Edges = GetSection<uint32>(bOutgoing ? Header->OutEdges : Header->InEdges);
+	return TConstArrayView<uint32>(Edges + Offsets[Index], Offsets[Index + 1] - Offsets[Index]);
+}
+
+int32 FCrvGraphFile::FindNode(const FString& PathName) const
+{
+	int32 Low = 0;
+	int32 High = NumNodes();
+	while (Low < High)
+	{
+		const int32 Middle = Low + (High - Low) / 2;
+		const int32 Compare = GetPathName(Middle).Compare(PathName, ESearchCase::CaseSensitive);
+		if (Compare == 0) { return Middle; }
+		if (Compare < 0)
+		{
+			Low = Middle + 1;
+		}
+		else
+		{
+			High = Middle;
+		}
+	}
+	return INDEX_NONE;
+}
+
+FString FCrvGraphFile::GetDefaultPath(const UWorld* World)
+{
+	const auto MapName = World ? FPackageName::GetShortName(World->GetOutermost()) : FString(TEXT("Untitled"));
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("CrvGraph"), MapName + TEXT(".crvg"));
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CrvSettings.h"
+#include "CrvUtils.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// Stored as-is in the file, all offsets are bytes from the start of the file
+struct FCrvGraphFileHeader
+{
+	static constexpr uint32 MagicValue = 0x47565243; // "CRVG"
+	static constexpr uint32 CurrentVersion = 1;
+
+	uint32 Magic = MagicValue;
+	uint32 Version = CurrentVersion;
+	uint32 NumNames = 0;
+	uint32 NumNodes = 0;
+	uint32 NumOutEdges = 0;
+	uint32 NumInEdges = 0;
+	// uint32[NumNames + 1], byte offset of each name in NameChars
+	uint64 NameOffsets = 0;
+	// UTF-8, not null terminated
+	uint64 NameChars = 0;
+	// FCrvGraphFileNode[NumNodes], sorted by case-sensitive path name
+	uint64 Nodes = 0;
+	// uint32[NumNodes + 1], edges of node N are Edges[Offsets[N]..Offsets[N + 1]], sorted by target node
+	uint64 OutOffsets = 0;
+	uint64 OutEdges = 0;
+	uint64 InOffsets = 0;
+	uint64 InEdges = 0;
+	uint64 FileSize = 0;
+};
+
+struct FCrvGraphFileNode
+{
+	// actor instance guid, zero for components & objects
+	FGuid ActorGuid;
+	// indices into the name table
+	uint32 PathName = 0;
+	uint32 Label = 0;
+	uint32 ClassPath = 0;
+	// ECrvObjectKind
+	uint8 Kind = 0;
+	// has its own references searched, rather than only being referenced
+	uint8 bIsRoot = 0;
+	uint16 Padding = 0;
+};
+
+static_assert(sizeof(FCrvGraphFileHeader) == 88, "FCrvGraphFileHeader layout is part of the file format");
+static_assert(sizeof(FCrvGraphFileNode) == 32, "FCrvGraphFileNode layout is part of the file format");
+
+/**
+ * Versioned binary reference graph: interned name table, node table & compressed sparse row edges for both directions.
+ * Opened by memory mapping & read in place. Sections, offsets & indices are all validated once when opening.
+ * Used to persist UCrvRefCache and by the CrvExportGraph commandlet.
+ */
+class FCrvGraphFile
+{
+public:
+	~FCrvGraphFile();
+
+	static TArray64<uint8> Write(const FCrvObjectGraph& Outgoing, const FCrvObjectGraph& Incoming);
+	static bool Save(const FString& Path, const FCrvObjectGraph& Outgoing, const FCrvObjectGraph& Incoming);
+	// Null if the file is missing, of another version, truncated or corrupt
+	static TUniquePtr<FCrvGraphFile> Open(const FString& Path);
+
+	int32 NumNodes() const { return Header->NumNodes; }
+	int32 NumEdges(ECrvDirection Direction) const;
+	const FCrvGraphFileNode& GetNode(int32 Index) const;
+	FUtf8StringView GetName(uint32 NameIndex) const;
+	FString GetPathName(int32 Index) const { return FString(GetName(GetNode(Index).PathName)); }
+	TConstArrayView<uint32> GetEdges(int32 Index, ECrvDirection Direction) const;
+	// Binary search by path name, INDEX_NONE if not found
+	int32 FindNode(const FString& PathName) const;
+
+	static FString GetDefaultPath(const UWorld* World);
+
+private:
+	FCrvGraphFile() = default;
+	bool Init(const uint8* InData, int64 InSize);
+
+	template <typename T>
+	const T* GetSection(const uint64 Offset) const { return reinterpret_cast<const T*>(Data + Offset); }
+
+	// region is destroyed before the handle
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	// used when the platform can't map files
+	TArray64<uint8> Loaded;
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+	const FCrvGraphFileHeader* Header = nullptr;
+};
@@ -1,7 +1,22 @@
 ﻿#include "CrvHitProxy.h"
 
+#include "ReferenceVisualizerComponent.h"
+
 IMPLEMENT_HIT_PROXY(HCrvHitProxy, HComponentVisProxy);
+IMPLEMENT_HIT_PROXY(HCrvLineClusterHitProxy, HCrvHitProxy);
 
 #define LOCTEXT_NAMESPACE "ReferenceVisualizer"
 
+int32 HCrvLineClusterHitProxy::FindNearestLine(const FVector& RayOrigin, const FVector& RayDirection, FVector& OutClosestPoint) const
+{
+	if (!Lines.IsValid() || !Lines->Clusters.IsValidIndex(ClusterIndex)) { return INDEX_NONE; }
+	return Lines->FindNearestLine(Lines->Clusters[ClusterIndex], RayOrigin, RayDirection, OutClosestPoint);
+}
+
+EMouseCursor::Type HCrvLineClusterHitProxy::GetMouseCursor()
+{
+	// hover is driven by mouse moves, see FCrvLinePicker::Hover
+	return EMouseCursor::Hand;
+}
+
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,214 @@
+﻿#include "CrvLinePicker.h"
+
+#include "ComponentVisualizer.h"
+#include "CrvHitProxy.h"
+#include "CrvRefSearch.h"
+#include "CtrlReferenceVisualizer.h"
+#include "EditorViewportClient.h"
+#include "LevelEditorViewport.h"
+#include "ReferenceVisualizerComponent.h"
+#include "SceneView.h"
+#include "UnrealEdGlobals.h"
+#include "UnrealClient.h"
+
+#include "Debug/DebugDrawService.h"
+
+#include "Editor/UnrealEdEngine.h"
+
+#include "Engine/Canvas.h"
+
+#include "Framework/Application/IInputProcessor.h"
+#include "Framework/Application/SlateApplication.h"
+
+#include "Slate/SceneViewport.h"
+
+// Forwards mouse moves to the picker before any widget handles them, without consuming them
+class FCrvHoverInputProcessor : public IInputProcessor
+{
+public:
+	explicit FCrvHoverInputProcessor(FCrvLinePicker* InPicker)
+		: Picker(InPicker) {}
+
+	virtual void Tick(const float DeltaTime, FSlateApplication& SlateApp, TSharedRef<ICursor> Cursor) override {}
+
+	virtual bool HandleMouseMoveEvent(FSlateApplication& SlateApp, const FPointerEvent& MouseEvent) override
+	{
+		Picker->Hover(MouseEvent.GetScreenSpacePosition());
+		return false;
+	}
+
+private:
+	FCrvLinePicker* Picker;
+};
+
+// Routes viewport clicks on line cluster hit proxies to the picker
+class FCrvComponentVisualizer : public FComponentVisualizer
+{
+public:
+	explicit FCrvComponentVisualizer(FCrvLinePicker* InPicker)
+		: Picker(InPicker) {}
+
+	virtual bool VisProxyHandleClick(FEditorViewportClient* InViewportClient, HComponentVisProxy* VisProxy, const FViewportClick& Click) override
+	{
+		if (!VisProxy || !VisProxy->IsA(HCrvLineClusterHitProxy::StaticGetType())) { return false; }
+		return Picker->Click(static_cast<HCrvLineClusterHitProxy*>(VisProxy), Click.GetOrigin(), Click.GetDirection());
+	}
+
+private:
+	FCrvLinePicker* Picker;
+};
+
+void FCrvLinePicker::Register()
+{
+	DrawHandle = UDebugDrawService::Register(TEXT("Editor"), FDebugDrawDelegate::CreateRaw(this, &FCrvLinePicker::DrawHUD));
+	if (GUnrealEd)
+	{
+		Visualizer = MakeShared<FCrvComponentVisualizer>(this);
+		GUnrealEd->RegisterComponentVisualizer(UReferenceVisualizerComponent::StaticClass()->GetFName(), Visualizer);
+		Visualizer->OnRegister();
+	}
+	if (FSlateApplication::IsInitialized())
+	{
+		InputProcessor = MakeShared<FCrvHoverInputProcessor>(this);
+		FSlateApplication::Get().RegisterInputPreProcessor(InputProcessor);
+	}
+}
+
+void FCrvLinePicker::Unregister()
+{
+	UDebugDrawService::Unregister(DrawHandle);
+	DrawHandle.Reset();
+	if (GUnrealEd && Visualizer.IsValid())
+	{
+		GUnrealEd->UnregisterComponentVisualizer(UReferenceVisualizerComponent::StaticClass()->GetFName());
+	}
+	Visualizer.Reset();
+	if (FSlateApplication::IsInitialized() && InputProcessor.IsValid())
+	{
+		FSlateApplication::Get().UnregisterInputPreProcessor(InputProcessor);
+	}
+	InputProcessor.Reset();
+	ClearHover();
+}
+
+void FCrvLinePicker::Hover(const FVector2D& ScreenPosition)
+{
+	if (!GEditor) { return; }
+	for (FLevelEditorViewportClient* Client : GEditor->GetLevelViewportClients())
+	{
+		if (!Client || !Client->Viewport || !Client->IsVisible()) { continue; }
+		// level editor viewports are scene viewports, their widget's geometry tells which one is under the cursor
+		const FGeometry& Geometry = static_cast<FSceneViewport*>(Client->Viewport)->GetCachedGeometry();
+		if (!Geometry.IsUnderLocation(ScreenPosition)) { continue; }
+		const FVector2D LocalPosition = Geometry.AbsoluteToLocal(ScreenPosition) * Geometry.Scale;
+		const FIntPoint MousePos(FMath::FloorToInt(LocalPosition.X), FMath::FloorToInt(LocalPosition.Y));
+		const HHitProxy* HitProxy = Client->Viewport->GetHitProxy(MousePos.X, MousePos.Y);
+		if (!HitProxy || !HitProxy->IsA(HCrvLineClusterHitProxy::StaticGetType()))
+		{
+			ClearHoverAndRedraw();
+			return;
+		}
+		const auto LineProxy = static_cast<const HCrvLineClusterHitProxy*>(HitProxy);
+
+		FSceneViewFamilyContext ViewFamily(
+			FSceneViewFamily::ConstructionValues(Client->Viewport, Client->GetScene(), Client->EngineShowFlags)
+			.SetRealtimeUpdate(Client->IsRealtime())
+		);
+		const FSceneView* View = Client->CalcSceneView(&ViewFamily);
+		const FViewportCursorLocation Cursor(View, Client, MousePos.X, MousePos.Y);
+		FVector Point;
+		const int32 LineIndex = LineProxy->FindNearestLine(Cursor.GetOrigin(), Cursor.GetDirection(), Point);
+		if (LineIndex == INDEX_NONE)
+		{
+			ClearHoverAndRedraw();
+			return;
+		}
+		SetHovered(LineProxy, LineIndex, Point, Client);
+		return;
+	}
+	ClearHoverAndRedraw();
+}
+
+bool FCrvLinePicker::Click(const HCrvLineClusterHitProxy* HitProxy, const FVector& RayOrigin, const FVector& RayDirection)
+{
+	FVector Point;
+	const int32 LineIndex = HitProxy->FindNearestLine(RayOrigin, RayDirection, Point);
+	if (LineIndex == INDEX_NONE) { return false; }
+	if (const auto Unloaded = HitProxy->Lines->UnloadedLeaves.Find(LineIndex))
+	{
+		ClearHover();
+		// the actor may have been loaded since the lines were built
+		if (const auto Actor = Unloaded->ActorPath.ResolveObject())
+		{
+			FCrvModule::Get().SelectReference(Actor);
+		}
+		else if (GEditor && Unloaded->Bounds.IsValid)
+		{
+			GEditor->MoveViewportCamerasToBox(Unloaded->Bounds, true);
+		}
+		return true;
+	}
+	const auto Leaf = HitProxy->Lines->Leaves[LineIndex];
+	if (!Leaf.IsValid()) { return false; }
+	ClearHover();
+	FCrvModule::Get().SelectReference(const_cast<UObject*>(Leaf.Get()));
+	return true;
+}
+
+void FCrvLinePicker::SetHovered(const HCrvLineClusterHitProxy* HitProxy, const int32 LineIndex, const FVector& Point, FLevelEditorViewportClient* Client)
+{
+	if (HoveredViewport != Client->Viewport)
+	{
+		ClearHoverAndRedraw();
+	}
+	if (HoveredLines != HitProxy->Lines || HoveredLineIndex != LineIndex)
+	{
+		// redraw so the label updates in non-realtime viewports
+		Client->Invalidate(false, false);
+		HoveredLines = HitProxy->Lines;
+		HoveredLineIndex = LineIndex;
+		const auto Direction = FCrvLines::GetPaletteDirection(HoveredLines->PaletteIndices[LineIndex]);
+		if (const auto Unloaded = HoveredLines->UnloadedLeaves.Find(LineIndex))
+		{
+			HoveredLabel = FCrvRefSearch::DescribeUnloadedReference(HitProxy->RootObject.Get(), Unloaded->Label, Unloaded->ActorPath, Direction);
+		}
+		else
+		{
+			HoveredLabel = FCrvRefSearch::DescribeReference(HitProxy->RootObject.Get(), HoveredLines->Leaves[LineIndex].Get(), Direction);
+		}
+	}
+	HoveredPoint = Point;
+	HoveredViewport = Client->Viewport;
+}
+
+void FCrvLinePicker::ClearHover()
+{
+	HoveredLines.Reset();
+	HoveredLineIndex = INDEX_NONE;
+	HoveredViewport = nullptr;
+	HoveredLabel.Reset();
+}
+
+void FCrvLinePicker::ClearHoverAndRedraw()
+{
+	if (!HoveredLines.IsValid()) { return; }
+	for (FLevelEditorViewportClient* Client : GEditor->GetLevelViewportClients())
+	{
+		if (Client && Client->Viewport == HoveredViewport)
+		{
+			Client->Invalidate(false, false);
+		}
+	}
+	ClearHover();
+}
+
+void FCrvLinePicker::DrawHUD(UCanvas* Canvas, APlayerController* PlayerController)
+{
+	if (!HoveredLines.IsValid() || HoveredLabel.IsEmpty()) { return; }
+	if (!Canvas || !Canvas->SceneView || Canvas->SceneView->Family->RenderTarget != HoveredViewport) { return; }
+
+	const FVector ScreenPoint = Canvas->Project(HoveredPoint);
+	if (ScreenPoint.Z <= 0) { return; }
+	Canvas->SetDrawColor(FColor::White);
+	Canvas->DrawText(GEngine->GetSmallFont(), HoveredLabel, ScreenPoint.X + 16.f, ScreenPoint.Y + 16.f);
+}
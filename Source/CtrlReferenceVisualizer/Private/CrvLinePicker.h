@@ -0,0 +1,47 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+class APlayerController;
+class FComponentVisualizer;
+class FLevelEditorViewportClient;
+class FViewport;
+class IInputProcessor;
+class UCanvas;
+struct FCrvLines;
+struct HCrvLineClusterHitProxy;
+
+/**
+ * Resolves hovered & clicked reference lines from their cluster hit proxies.
+ * Hover follows mouse moves over the level viewport under the cursor, read from its hit proxy map.
+ * Draws a label describing the hovered reference, and selects the referenced object on click.
+ */
+class FCrvLinePicker
+{
+public:
+	void Register();
+	void Unregister();
+
+	// Cursor position in desktop space
+	void Hover(const FVector2D& ScreenPosition);
+	bool Click(const HCrvLineClusterHitProxy* HitProxy, const FVector& RayOrigin, const FVector& RayDirection);
+
+private:
+	void SetHovered(const HCrvLineClusterHitProxy* HitProxy, int32 LineIndex, const FVector& Point, FLevelEditorViewportClient* Client);
+	void ClearHover();
+	// Clear & redraw the viewport the label was shown in
+	void ClearHoverAndRedraw();
+	void DrawHUD(UCanvas* Canvas, APlayerController* PlayerController);
+
+	TSharedPtr<const FCrvLines> HoveredLines;
+	int32 HoveredLineIndex = INDEX_NONE;
+	FVector HoveredPoint = FVector::ZeroVector;
+	// only dereferenced while it is the viewport being drawn
+	FViewport* HoveredViewport = nullptr;
+	// built once per hovered line
+	FString HoveredLabel;
+
+	FDelegateHandle DrawHandle;
+	TSharedPtr<IInputProcessor> InputProcessor;
+	TSharedPtr<FComponentVisualizer> Visualizer;
+};
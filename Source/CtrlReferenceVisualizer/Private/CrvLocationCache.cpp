@@ -0,0 +1,61 @@
+﻿#include "CrvLocationCache.h"
+
+#include "ReferenceVisualizerComponent.h"
+
+const UObject* FCrvLocationCache::GetAnchor(const UObject* Object)
+{
+	if (!Object) { return nullptr; }
+	if (const auto Component = Cast<UActorComponent>(Object))
+	{
+		// non-scene components are drawn at their owner's origin
+		if (!Component->IsA<USceneComponent>() && Component->GetOwner())
+		{
+			return Component->GetOwner();
+		}
+		return Component;
+	}
+	if (Object->IsA<AActor>())
+	{
+		return Object;
+	}
+	if (const auto OwnerComponent = Object->GetTypedOuter<UActorComponent>())
+	{
+		return GetAnchor(OwnerComponent);
+	}
+	return Object->GetTypedOuter<AActor>();
+}
+
+FVector FCrvLocationCache::GetLocation(const UObject* Object)
+{
+	const auto Anchor = GetAnchor(Object);
+	if (!Anchor) { return FVector::ZeroVector; }
+	if (const auto Found = Locations.Find(Anchor))
+	{
+		return *Found;
+	}
+	if (Locations.Num() >= MaxLocations)
+	{
+		Locations.Reset();
+	}
+	return Locations.Add(Anchor, FCtrlReferenceVisualizerSceneProxy::GetObjectLocation(Anchor));
+}
+
+bool FCrvLocationCache::Invalidate(const UObject* Object)
+{
+	if (!Object || Locations.IsEmpty()) { return false; }
+	bool bRemoved = Locations.Remove(Object) > 0;
+	// actor bounds depend on all of its components
+	if (const auto Component = Cast<UActorComponent>(Object))
+	{
+		if (const auto Owner = Component->GetOwner())
+		{
+			bRemoved |= Locations.Remove(Owner) > 0;
+		}
+	}
+	return bRemoved;
+}
+
+void FCrvLocationCache::Reset()
+{
+	Locations.Reset();
+}
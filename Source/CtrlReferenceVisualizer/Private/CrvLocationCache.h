@@ -0,0 +1,30 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+/**
+ * Caches the endpoint location of actors & components drawn by the visualizer.
+ * All lines sharing an endpoint reuse the cached value.
+ * Entries are dropped when the endpoint's transform or bounds change.
+ * Entries of deleted objects are never looked up again, so the cache starts over once it reaches MaxLocations.
+ */
+class FCrvLocationCache
+{
+public:
+	// Object whose location is used as the endpoint for lines to/from Object (a component or an actor)
+	static const UObject* GetAnchor(const UObject* Object);
+
+	FVector GetLocation(const UObject* Object);
+
+	// Remove cached locations affected by Object changing. Returns true if any were cached.
+	bool Invalidate(const UObject* Object);
+	void Reset();
+
+	int32 Num() const { return Locations.Num(); }
+
+	static constexpr int32 MaxLocations = 65536;
+
+private:
+	TMap<TObjectKey<UObject>, FVector> Locations;
+};
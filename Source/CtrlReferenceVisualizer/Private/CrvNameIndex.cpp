@@ -0,0 +1,201 @@
+#include "CrvNameIndex.h"
+
+#include "Components/ActorComponent.h"
+#include "GameFramework/Actor.h"
+
+FString FCrvNameIndex::GetLabel(const UObject* Object)
+{
+	if (const auto Actor = Cast<AActor>(Object))
+	{
+		return Actor->GetActorNameOrLabel();
+	}
+	if (const auto Component = Cast<UActorComponent>(Object))
+	{
+		return Component->GetReadableName();
+	}
+	return GetNameSafe(Object);
+}
+
+uint64 FCrvNameIndex::MakeTrigram(const TCHAR* Chars)
+{
+	return static_cast<uint64>(static_cast<uint16>(Chars[0]))
+		| static_cast<uint64>(static_cast<uint16>(Chars[1])) << 16
+		| static_cast<uint64>(static_cast<uint16>(Chars[2])) << 32;
+}
+
+void FCrvNameIndex::Sync(const FCrvWeakGraph& Outgoing, const FCrvWeakGraph& Incoming)
+{
+	++Generation;
+	auto Visit = [this](const TWeakObjectPtr<UObject>& WeakObject)
+	{
+		const auto Object = WeakObject.Get();
+		if (!Object) { return; }
+		if (!NodeIds.Contains(Object))
+		{
+			Add(Object);
+		}
+		Nodes[NodeIds[Object]].Generation = Generation;
+	};
+	for (const auto Graph : {&Outgoing, &Incoming})
+	{
+		for (const auto& [Key, Values] : *Graph)
+		{
+			Visit(Key);
+			for (const auto& Value : Values)
+			{
+				Visit(Value);
+			}
+		}
+	}
+
+	for (int32 Id = 0; Id < Nodes.Num(); ++Id)
+	{
+		if (Nodes[Id].Generation != Generation && IsLive(Id))
+		{
+			RemoveAt(Id);
+		}
+	}
+	if (NumRemoved > Nodes.Num() / 2)
+	{
+		Rebuild();
+	}
+}
+
+void FCrvNameIndex::Add(UObject* Object)
+{
+	if (!Object || NodeIds.Contains(Object)) { return; }
+	const int32 Id = Nodes.Add({Object, Object, GetLabel(Object).ToLower(), Generation});
+	NodeIds.Add(Object, Id);
+	AddTrigrams(Id);
+}
+
+void FCrvNameIndex::Remove(const UObject* Object)
+{
+	if (const auto Id = NodeIds.Find(Object))
+	{
+		RemoveAt(*Id);
+	}
+}
+
+void FCrvNameIndex::Update(UObject* Object)
+{
+	const auto Id = NodeIds.Find(Object);
+	if (!Id) { return; }
+	auto Label = GetLabel(Object).ToLower();
+	if (Label == Nodes[*Id].Label) { return; }
+	// stale trigrams of the old label are filtered out when matching
+	RemoveAt(*Id);
+	Add(Object);
+}
+
+void FCrvNameIndex::Reset()
+{
+	Nodes.Reset();
+	NodeIds.Reset();
+	Trigrams.Reset();
+	NumRemoved = 0;
+}
+
+void FCrvNameIndex::AddTrigrams(const int32 Id)
+{
+	const FString& Label = Nodes[Id].Label;
+	TSet<uint64, DefaultKeyFuncs<uint64>, TInlineSetAllocator<64>> Unique;
+	for (int32 Index = 0; Index + 3 <= Label.Len(); ++Index)
+	{
+		const auto Trigram = MakeTrigram(*Label + Index);
+		if (Unique.Contains(Trigram)) { continue; }
+		Unique.Add(Trigram);
+		Trigrams.FindOrAdd(Trigram).Add(Id);
+	}
+}
+
+bool FCrvNameIndex::IsLive(const int32 Id) const
+{
+	// removed objects may have been added again under a new id
+	const auto Found = NodeIds.Find(Nodes[Id].Key);
+	return Found && *Found == Id;
+}
+
+void FCrvNameIndex::RemoveAt(const int32 Id)
+{
+	if (!IsLive(Id)) { return; }
+	NodeIds.Remove(Nodes[Id].Key);
+	Nodes[Id].Object.Reset();
+	Nodes[Id].Label.Empty();
+	++NumRemoved;
+}
+
+void FCrvNameIndex::Rebuild()
+{
+	TArray<UObject*> Objects;
+	Objects.Reserve(NodeIds.Num());
+	for (const auto& Node : Nodes)
+	{
+		if (const auto Object = Node.Object.Get(); Object && !Node.Label.IsEmpty())
+		{
+			Objects.Add(Object);
+		}
+	}
+	Reset();
+	for (const auto Object : Objects)
+	{
+		Add(Object);
+	}
+}
+
+TArray<UObject*> FCrvNameIndex::Find(const FString& Query, const int32 MaxResults) const
+{
+	TArray<UObject*> Results;
+	auto Pattern = Query.TrimStartAndEnd().ToLower();
+	if (Pattern.IsEmpty()) { return Results; }
+	if (!Pattern.Contains(TEXT("*")) && !Pattern.Contains(TEXT("?")))
+	{
+		Pattern = FString::Printf(TEXT("*%s*"), *Pattern);
+	}
+
+	// candidates are the shortest posting list of any trigram in the literal parts of the pattern
+	const TArray<int32>* Candidates = nullptr;
+	bool bHasTrigram = false;
+	TArray<FString> Literals;
+	Pattern.Replace(TEXT("?"), TEXT("*")).ParseIntoArray(Literals, TEXT("*"));
+	for (const auto& Literal : Literals)
+	{
+		for (int32 Index = 0; Index + 3 <= Literal.Len(); ++Index)
+		{
+			bHasTrigram = true;
+			const auto Found = Trigrams.Find(MakeTrigram(*Literal + Index));
+			if (!Found) { return Results; }
+			if (!Candidates || Found->Num() < Candidates->Num())
+			{
+				Candidates = Found;
+			}
+		}
+	}
+
+	auto TryAdd = [&](const int32 Id)
+	{
+		const auto& Node = Nodes[Id];
+		if (!IsLive(Id) || !Node.Label.MatchesWildcard(Pattern)) { return; }
+		if (const auto Object = Node.Object.Get())
+		{
+			Results.Add(Object);
+		}
+	};
+	if (bHasTrigram)
+	{
+		for (const int32 Id : *Candidates)
+		{
+			TryAdd(Id);
+			if (Results.Num() >= MaxResults) { break; }
+		}
+	}
+	else
+	{
+		// too short to use the index
+		for (int32 Id = 0; Id < Nodes.Num() && Results.Num() < MaxResults; ++Id)
+		{
+			TryAdd(Id);
+		}
+	}
+	return Results;
+}
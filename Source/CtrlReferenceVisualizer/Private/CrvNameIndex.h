@@ -0,0 +1,54 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CrvUtils.h"
+#include "UObject/ObjectKey.h"
+
+/**
+ * Trigram index over the display labels of objects in a reference graph.
+ * Synced with the graph after each cache update, only objects new to the graph are labelled & indexed.
+ * Removed objects are left as tombstones until they make up half the index, then it is rebuilt.
+ */
+class FCrvNameIndex
+{
+public:
+	// Actor label, readable component name or object name
+	static FString GetLabel(const UObject* Object);
+
+	// Index objects in the graphs that aren't indexed yet, and remove objects no longer in them
+	void Sync(const FCrvWeakGraph& Outgoing, const FCrvWeakGraph& Incoming);
+	void Add(UObject* Object);
+	void Remove(const UObject* Object);
+	// Re-label an object e.g. after renaming it
+	void Update(UObject* Object);
+	void Reset();
+
+	// Case-insensitive. Queries with * or ? match the whole label, otherwise they match anywhere in it.
+	TArray<UObject*> Find(const FString& Query, int32 MaxResults = MAX_int32) const;
+
+	bool Contains(const UObject* Object) const { return NodeIds.Contains(Object); }
+	int32 Num() const { return NodeIds.Num(); }
+
+private:
+	struct FNode
+	{
+		TWeakObjectPtr<UObject> Object;
+		TObjectKey<UObject> Key;
+		// lowercase
+		FString Label;
+		uint32 Generation = 0;
+	};
+
+	static uint64 MakeTrigram(const TCHAR* Chars);
+	bool IsLive(int32 Id) const;
+	void AddTrigrams(int32 Id);
+	void RemoveAt(int32 Id);
+	void Rebuild();
+
+	TArray<FNode> Nodes;
+	TMap<TObjectKey<UObject>, int32> NodeIds;
+	// ids of nodes whose label contains each trigram, may include removed nodes
+	TMap<uint64, TArray<int32>> Trigrams;
+	int32 NumRemoved = 0;
+	uint32 Generation = 0;
+};
@@ -1,7 +1,9 @@
 ﻿#include "CrvRefCache.h"
 
+#include "CrvGraphFile.h"
 #include "CrvRefSearch.h"
 #include "CrvSettings.h"
+#include "CrvTrace.h"
 #include "CrvUtils.h"
 #include "CtrlReferenceVisualizer.h"
 #include "Algo/AnyOf.h"
@@ -22,6 +24,7 @@ void UCrvRefCache::Reset(const FString& Reason)
 	WeakRootObjects.Reset();
 	Outgoing.Reset();
 	Incoming.Reset();
+	FCrvRefSearch::ResetToolTips();
 	UE_CLOG(FCrvModule::IsDebugEnabled(), LogCrv, Log, TEXT("Cache reset... %s"), *Reason);
 }
 
@@ -53,22 +56,10 @@ TSet<UObject*> UCrvRefCache::GetReferences(const UObject* Object, const ECrvDire
 
 FCrvSet UCrvRefCache::GenerateAllRootObjects()
 {
-	FCrvSet All;
-	for (TObjectIterator<UReferenceVisualizerComponent> It; It; ++It)
-	{
-		if (const auto Item = *It)
-		{
-			if (Item->HasAnyFlags(RF_ClassDefaultObject))
-			{
-				continue;
-			}
-			if (const auto Owner = Item->GetOwner())
-			{
-				All.Add(Owner);
-			}
-		}
-	}
-	return MoveTemp(All);
+	// registered components of the level being edited, not PIE, other worlds or transaction buffer copies
+	const auto Subsystem = GEditor ? GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>() : nullptr;
+	if (!Subsystem) { return {}; }
+	return Subsystem->GetRegisteredOwners(GEditor->GetEditorWorldContext().World());
 }
 
 FCrvSet UCrvRefCache::GenerateRootObjects()
@@ -102,12 +93,22 @@ FCrvSet UCrvRefCache::GenerateRootObjects()
 
 void UCrvRefCache::UpdateCache()
 {
-	GEditor->GetTimerManager()->ClearTimer(UpdateCacheNextTickHandle);
+	CRV_TRACE_SCOPE("Crv::UpdateCache");
+	// keeps a scheduled update's pass open until the cache is filled
+	const Trace::FPassScope Pass(TEXT("UpdateCache"));
+	CancelScheduledUpdate();
 	FillCache(GenerateRootObjects());
 }
 
 void UCrvRefCache::ScheduleUpdate()
 {
+	CRV_TRACE_SCOPE("Crv::ScheduleUpdate");
+	// the pass stays open until the update runs or is cancelled, rescheduling keeps the same pass
+	if (!bHasScheduledPass)
+	{
+		Trace::BeginPass(TEXT("ScheduleUpdate"));
+		bHasScheduledPass = true;
+	}
 	GEditor->GetTimerManager()->ClearTimer(UpdateCacheNextTickHandle);
 	auto WeakThis = TWeakObjectPtr<UCrvRefCache>(this);
 	UpdateCacheNextTickHandle = GEditor->GetTimerManager()->SetTimerForNextTick([WeakThis]()
@@ -116,9 +117,22 @@ void UCrvRefCache::ScheduleUpdate()
 		{
 			WeakThis->UpdateCache();
 		}
+		else
+		{
+			// nothing else can release the destroyed cache's pass
+			Trace::EndPass();
+		}
 	});
 }
 
+void UCrvRefCache::CancelScheduledUpdate()
+{
+	GEditor->GetTimerManager()->ClearTimer(UpdateCacheNextTickHandle);
+	if (!bHasScheduledPass) { return; }
+	bHasScheduledPass = false;
+	Trace::EndPass();
+}
+
 FCrvObjectGraph UCrvRefCache::GetValidCached(const ECrvDirection Direction)
 {
 	static FCrvObjectGraph Empty;
@@ -233,6 +247,8 @@ void UCrvRefCache::AutoAddComponents(const FCrvSet& InRootObjects)
 
 void UCrvRefCache::FillCache(const FCrvSet& InRootObjects)
 {
+	CRV_TRACE_SCOPE("Crv::FillCache");
+	const Trace::FPassScope Pass(TEXT("FillCache"));
 	if (bCached && !AreSetsEqual(ResolveWeakSet(WeakRootObjects), InRootObjects))
 	{
 		Reset(FString::Printf(TEXT("FillCache: RootObjects Changed")));
@@ -243,6 +259,7 @@ void UCrvRefCache::FillCache(const FCrvSet& InRootObjects)
 	WeakRootObjects = ToWeakSet(InRootObjects);
 	WeakRootObjects.Compact();
 	const auto RootObjects = InRootObjects;
+	TRACE_COUNTER_SET(CrvRootObjects, RootObjects.Num());
 
 	if (bCached)
 	{
@@ -254,6 +271,8 @@ void UCrvRefCache::FillCache(const FCrvSet& InRootObjects)
 	{
 		FCrvObjectGraph OutRefs;
 		FCrvRefSearch::FindOutRefs(RootObjects, OutRefs);
+		TRACE_COUNTER_SET(CrvOutgoingRefs, CountEdges(OutRefs));
+		CRV_TRACE_SCOPE("Crv::WeakenGraph");
 		Outgoing = ToWeakGraph(OutRefs);
 		Outgoing.Compact();
 	}
@@ -266,6 +285,8 @@ void UCrvRefCache::FillCache(const FCrvSet& InRootObjects)
 	{
 		FCrvObjectGraph InRefs;
 		FCrvRefSearch::FindInRefs(RootObjects, InRefs);
+		TRACE_COUNTER_SET(CrvIncomingRefs, CountEdges(InRefs));
+		CRV_TRACE_SCOPE("Crv::WeakenGraph");
 		Incoming = ToWeakGraph(InRefs);
 		Incoming.Compact();
 	}
@@ -279,11 +300,120 @@ void UCrvRefCache::FillCache(const FCrvSet& InRootObjects)
 		bHadValidItems = HasValidItems(Outgoing) || HasValidItems(Incoming);
 	}
 
+	// listeners read the cache through GetValidCached
+	bCached = HasValues();
+	if (OnCacheUpdated.IsBound())
+	{
+		CRV_TRACE_SCOPE("Crv::OnCacheUpdated");
+		OnCacheUpdated.Broadcast();
+	}
+
+	UE_CLOG(FCrvModule::IsDebugEnabled(), LogCrv, Log, TEXT("Cache filled: Pass: %u, RootObjects: %d, Outgoing: %d, Incoming: %d"), Pass.PassId, RootObjects.Num(), Outgoing.Num(), Incoming.Num());
+}
+
+void UCrvRefCache::ApplyRootDelta(const FCrvSet& Added, const FCrvSet& Removed)
+{
+	if (!bCached)
+	{
+		UpdateCache();
+		return;
+	}
+	CRV_TRACE_SCOPE("Crv::ApplyRootDelta");
+	const Trace::FPassScope Pass(TEXT("ApplyRootDelta"));
+	CancelScheduledUpdate();
+
+	for (const auto Object : Removed)
+	{
+		WeakRootObjects.Remove(Object);
+		Outgoing.Remove(Object);
+		Incoming.Remove(Object);
+	}
+	FCrvSet NewRoots;
+	for (const auto Object : Added)
+	{
+		if (!WeakRootObjects.Contains(Object))
+		{
+			NewRoots.Add(Object);
+		}
+	}
+	WeakRootObjects.Append(ToWeakSet(NewRoots));
+	AutoAddComponents(ResolveWeakSet(WeakRootObjects));
+	TRACE_COUNTER_SET(CrvRootObjects, WeakRootObjects.Num());
+
+	const auto Config = GetDefault<UCrvSettings>();
+	if (Config->bShowOutgoingReferences && NewRoots.Num())
+	{
+		FCrvObjectGraph OutRefs;
+		FCrvRefSearch::FindOutRefs(NewRoots, OutRefs);
+		TRACE_COUNTER_SET(CrvOutgoingRefs, CountEdges(OutRefs));
+		CRV_TRACE_SCOPE("Crv::WeakenGraph");
+		Outgoing.Append(ToWeakGraph(OutRefs));
+	}
+	if (Config->bShowIncomingReferences && NewRoots.Num())
+	{
+		FCrvObjectGraph InRefs;
+		FCrvRefSearch::FindInRefs(NewRoots, InRefs);
+		TRACE_COUNTER_SET(CrvIncomingRefs, CountEdges(InRefs));
+		CRV_TRACE_SCOPE("Crv::WeakenGraph");
+		Incoming.Append(ToWeakGraph(InRefs));
+	}
+
+	if (!bHadValidItems)
+	{
+		bHadValidItems = HasValidItems(Outgoing) || HasValidItems(Incoming);
+	}
+
+	// listeners read the cache through GetValidCached
+	bCached = HasValues();
 	if (OnCacheUpdated.IsBound())
 	{
+		CRV_TRACE_SCOPE("Crv::OnCacheUpdated");
 		OnCacheUpdated.Broadcast();
 	}
 
+	UE_CLOG(FCrvModule::IsDebugEnabled(), LogCrv, Log, TEXT("Cache roots updated: Pass: %u, +%d -%d, RootObjects: %d, Outgoing: %d, Incoming: %d"), Pass.PassId, NewRoots.Num(), Removed.Num(), WeakRootObjects.Num(), Outgoing.Num(), Incoming.Num());
+}
+
+bool UCrvRefCache::SaveToFile(const FString& Path)
+{
+	return FCrvGraphFile::Save(Path, GetValidCached(ECrvDirection::Outgoing), GetValidCached(ECrvDirection::Incoming));
+}
+
+bool UCrvRefCache::LoadFromFile(const FString& Path)
+{
+	const auto File = FCrvGraphFile::Open(Path);
+	if (!File) { return false; }
+	Reset(FString::Printf(TEXT("LoadFromFile: %s"), *Path));
+
+	TArray<TWeakObjectPtr<UObject>> Objects;
+	Objects.SetNum(File->NumNodes());
+	for (int32 Index = 0; Index < File->NumNodes(); ++Index)
+	{
+		Objects[Index] = FSoftObjectPath(File->GetPathName(Index)).ResolveObject();
+	}
+	for (int32 Index = 0; Index < File->NumNodes(); ++Index)
+	{
+		if (!File->GetNode(Index).bIsRoot || !Objects[Index].IsValid()) { continue; }
+		WeakRootObjects.Add(Objects[Index]);
+		for (const auto Direction : {ECrvDirection::Outgoing, ECrvDirection::Incoming})
+		{
+			auto& Leaves = (Direction == ECrvDirection::Outgoing ? Outgoing : Incoming).Add(Objects[Index]);
+			for (const uint32 Leaf : File->GetEdges(Index, Direction))
+			{
+				if (Objects[Leaf].IsValid())
+				{
+					Leaves.Add(Objects[Leaf]);
+				}
+			}
+		}
+	}
+
+	bHadValidItems = HasValidItems(Outgoing) || HasValidItems(Incoming);
 	bCached = HasValues();
-	UE_CLOG(FCrvModule::IsDebugEnabled(), LogCrv, Log, TEXT("Cache filled: RootObjects: %d, Outgoing: %d, Incoming: %d"), RootObjects.Num(), Outgoing.Num(), Incoming.Num());
+	if (OnCacheUpdated.IsBound())
+	{
+		OnCacheUpdated.Broadcast();
+	}
+	UE_CLOG(FCrvModule::IsDebugEnabled(), LogCrv, Log, TEXT("Cache loaded from %s: RootObjects: %d, Outgoing: %d, Incoming: %d"), *Path, WeakRootObjects.Num(), Outgoing.Num(), Incoming.Num());
+	return true;
 }
@@ -22,6 +22,8 @@ public:
 	bool Contains(const UObject* Object) const;
 
 	void FillCache(const FCrvSet& InRootObjects);
+	// Search only the added roots & drop the removed ones, rather than refilling the whole cache
+	void ApplyRootDelta(const FCrvSet& Added, const FCrvSet& Removed);
 	void Reset(const FString& String);
 	// reset + schedule update
 	void Invalidate(const FString& Reason);
@@ -33,6 +35,11 @@ public:
 	void UpdateCache();
 	void ScheduleUpdate();
 
+	// Persist the cached graphs, see FCrvGraphFile
+	bool SaveToFile(const FString& Path);
+	// Replace the cache with a saved graph, references to objects that aren't loaded are dropped
+	bool LoadFromFile(const FString& Path);
+
 	FCrvWeakGraph Outgoing;
 	FCrvWeakGraph Incoming;
 	// Objects we want to find references for
@@ -49,7 +56,11 @@ protected:
 	UPROPERTY(Transient)
 	TSet<TWeakObjectPtr<UReferenceVisualizerComponent>> AutoCreatedComponents;
 private:
+	// Clears the scheduled update & releases the trace pass it held open
+	void CancelScheduledUpdate();
+
 	FTimerHandle UpdateCacheNextTickHandle;
+	bool bHasScheduledPass = false;
 };
 
 struct FCrvHitProxyRef
@@ -1,13 +1,14 @@
 ﻿#include "CrvRefSearch.h"
 
+#include "CrvClassInfoCache.h"
 #include "CrvSettings.h"
+#include "CrvTrace.h"
 #include "CrvUtils.h"
 #include "CtrlReferenceVisualizer.h"
 #include "ReferenceVisualizerComponent.h"
 #include "Selection.h"
 
-#include "Styling/SlateIconFinder.h"
-
+#include "UObject/PropertyIterator.h"
 #include "UObject/ReferenceChainSearch.h"
 #include "UObject/ReferencerFinder.h"
 
@@ -180,40 +181,75 @@ namespace CtrlRefViz::Search
 #pragma endregion GetObjectFlagsString
 }
 
-FCrvMenuItem FCrvRefSearch::MakeMenuEntry(const UObject* Parent, const UObject* Object)
+namespace CtrlRefViz::Search
 {
-	static FCrvMenuItem Empty;
-	if (!Object)
-	{
-		return Empty;
-	}
-	const auto FlagsString = Search::GetObjectFlagsString(Object);
-	const auto PackageShortName = FPackageName::GetShortName(Object->GetPackage()->GetName());
-	auto Tooltip = FString::Printf(TEXT("%s\nPath: %s\nPkgName: %s\nFlags: %s"), *GetDebugName(Object), *GetPathNameSafe(Object), *PackageShortName, *FlagsString);
-	if (const auto OuterActor = Object->GetTypedOuter<AActor>())
+	// cleared with the cache, so it only grows until the next reset
+	static TMap<TObjectKey<UObject>, FText> ToolTips;
+
+	static FText BuildToolTip(const UObject* Object)
 	{
-		if (OuterActor != Object)
+		const auto FlagsString = GetObjectFlagsString(Object);
+		const auto PackageShortName = FPackageName::GetShortName(Object->GetPackage()->GetName());
+		auto Tooltip = FString::Printf(TEXT("%s\nPath: %s\nPkgName: %s\nFlags: %s"), *GetDebugName(Object), *GetPathNameSafe(Object), *PackageShortName, *FlagsString);
+		if (const auto OuterActor = Object->GetTypedOuter<AActor>())
 		{
-			Tooltip += FString::Printf(TEXT("\nOuterActor: %s"), *OuterActor->GetActorNameOrLabel());
+			if (OuterActor != Object)
+			{
+				Tooltip += FString::Printf(TEXT("\nOuterActor: %s"), *OuterActor->GetActorNameOrLabel());
+			}
+		}
+		if (const auto OuterComponent = Object->GetTypedOuter<UActorComponent>())
+		{
+			if (OuterComponent != Object)
+			{
+				Tooltip += FString::Printf(TEXT("\nOuterComponent: %s"), *OuterComponent->GetReadableName());
+			}
 		}
+		if (const auto Actor = Cast<AActor>(Object))
+		{
+			Tooltip += FString::Printf(TEXT("\nGuid: %s"), *Actor->GetActorInstanceGuid().ToString());
+		}
+		return FText::FromString(Tooltip);
 	}
-	if (const auto OuterComponent = Object->GetTypedOuter<UActorComponent>())
-	{
-		if (OuterComponent != Object)
+}
+
+TAttribute<FText> FCrvRefSearch::MakeToolTip(const UObject* Object)
+{
+	return TAttribute<FText>::CreateLambda(
+		[WeakObject = TWeakObjectPtr<const UObject>(Object)]()
 		{
-			Tooltip += FString::Printf(TEXT("\nOuterComponent: %s"), *OuterComponent->GetReadableName());
+			const auto Object = WeakObject.Get();
+			if (!Object) { return FText::GetEmpty(); }
+			if (const auto Found = Search::ToolTips.Find(Object))
+			{
+				return *Found;
+			}
+			return Search::ToolTips.Add(Object, Search::BuildToolTip(Object));
 		}
+	);
+}
+
+void FCrvRefSearch::ResetToolTips()
+{
+	Search::ToolTips.Reset();
+}
+
+FCrvMenuItem FCrvRefSearch::MakeMenuEntry(const UObject* Parent, const UObject* Object)
+{
+	static FCrvMenuItem Empty;
+	if (!Object)
+	{
+		return Empty;
 	}
 
 	if (const auto Actor = Cast<AActor>(Object))
 	{
 		const auto Label = FText::FromString(FString::Printf(TEXT("%s"), *Actor->GetActorNameOrLabel()));
-		const auto ActorTooltip = FText::FromString(FString::Printf(TEXT("%ls\nGuid: %s"), *Tooltip, *Actor->GetActorInstanceGuid().ToString()));
 		return {
 			Actor->GetFName(),
 			Label,
-			ActorTooltip,
-			FSlateIconFinder::FindIconForClass(Actor->GetClass()),
+			MakeToolTip(Actor),
+			FCrvModule::Get().GetClassInfo(Actor->GetClass()).Icon,
 			FUIAction(
 				FExecuteAction::CreateWeakLambda(
 					Actor,
@@ -231,8 +267,8 @@ FCrvMenuItem FCrvRefSearch::MakeMenuEntry(const UObject* Parent, const UObject*
 		return {
 			Component->GetFName(),
 			Label,
-			FText::FromString(Tooltip),
-			FSlateIconFinder::FindIconForClass(Component->GetClass()),
+			MakeToolTip(Component),
+			FCrvModule::Get().GetClassInfo(Component->GetClass()).Icon,
 			FUIAction(
 				FExecuteAction::CreateWeakLambda(
 					Component,
@@ -248,12 +284,134 @@ FCrvMenuItem FCrvRefSearch::MakeMenuEntry(const UObject* Parent, const UObject*
 	return {
 		Object->GetFName(),
 		FText::FromString(Object->GetName()),
-		FText::FromString(Tooltip),
-		FSlateIconFinder::FindIconForClass(Object->GetClass()),
+		MakeToolTip(Object),
+		FCrvModule::Get().GetClassInfo(Object->GetClass()).Icon,
 		FUIAction()
 	};
 }
 
+namespace CtrlRefViz::Search
+{
+	bool CanHoldReferences(const FProperty* Property, TSet<const UStruct*>& VisitedStructs)
+	{
+		if (Property->IsA<FObjectPropertyBase>() || Property->IsA<FInterfaceProperty>())
+		{
+			return true;
+		}
+		if (const auto ArrayProperty = CastField<FArrayProperty>(Property))
+		{
+			return CanHoldReferences(ArrayProperty->Inner, VisitedStructs);
+		}
+		if (const auto SetProperty = CastField<FSetProperty>(Property))
+		{
+			return CanHoldReferences(SetProperty->ElementProp, VisitedStructs);
+		}
+		if (const auto MapProperty = CastField<FMapProperty>(Property))
+		{
+			return CanHoldReferences(MapProperty->KeyProp, VisitedStructs) || CanHoldReferences(MapProperty->ValueProp, VisitedStructs);
+		}
+		if (const auto StructProperty = CastField<FStructProperty>(Property))
+		{
+			// structs can contain containers of themselves
+			bool bAlreadyVisited = false;
+			VisitedStructs.Add(StructProperty->Struct, &bAlreadyVisited);
+			if (bAlreadyVisited) { return false; }
+			for (TFieldIterator<FProperty> It(StructProperty->Struct); It; ++It)
+			{
+				if (CanHoldReferences(*It, VisitedStructs))
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+}
+
+bool Search::CanHoldReferences(const FProperty* Property)
+{
+	if (!Property) { return true; }
+	TSet<const UStruct*> VisitedStructs;
+	return CanHoldReferences(Property, VisitedStructs);
+}
+
+TArray<FString> Search::FindPropertyPaths(const UObject* Referencer, TFunctionRef<bool(const UObject*)> IsReferenced)
+{
+	TArray<FString> Paths;
+	if (!IsValid(Referencer)) { return Paths; }
+	for (TPropertyValueIterator<FObjectPropertyBase> It(Referencer->GetClass(), Referencer); It; ++It)
+	{
+		const UObject* Value = It.Key()->GetObjectPropertyValue(It.Value());
+		if (!Value || !IsReferenced(Value)) { continue; }
+
+		// chain is ordered from the current property to the outermost one
+		TArray<const FProperty*> Chain;
+		It.GetPropertyChain(Chain);
+		FString Path;
+		FName PreviousName;
+		for (int32 Index = Chain.Num() - 1; Index >= 0; --Index)
+		{
+			// container inner properties share the container's name
+			if (Chain[Index]->GetFName() == PreviousName) { continue; }
+			PreviousName = Chain[Index]->GetFName();
+			Path += Path.IsEmpty() ? Chain[Index]->GetName() : TEXT(".") + Chain[Index]->GetName();
+		}
+		Paths.AddUnique(Path);
+	}
+	return Paths;
+}
+
+TArray<FString> Search::FindReferencePaths(const UObject* RootObject, const FCrvSet& TargetObjects, const UObject* LeafObject, const ECrvDirection Direction)
+{
+	TArray<FString> Paths;
+	if (Direction == ECrvDirection::Outgoing)
+	{
+		for (const auto TargetObject : TargetObjects)
+		{
+			for (const auto& Path : FindPropertyPaths(TargetObject, [LeafObject](const UObject* Value) { return Value == LeafObject; }))
+			{
+				Paths.Add(TargetObject == RootObject ? Path : FString::Printf(TEXT("%s.%s"), *TargetObject->GetName(), *Path));
+			}
+		}
+	}
+	else
+	{
+		Paths = FindPropertyPaths(LeafObject, [&TargetObjects](const UObject* Value) { return TargetObjects.Contains(const_cast<UObject*>(Value)); });
+	}
+	return Paths;
+}
+
+FString FCrvRefSearch::DescribeReference(const UObject* RootObject, const UObject* LeafObject, const ECrvDirection Direction)
+{
+	if (!IsValid(RootObject) || !IsValid(LeafObject)) { return FString(); }
+	const auto TargetObjects = Search::FindTargetObjects(const_cast<UObject*>(RootObject));
+	const auto Paths = Search::FindReferencePaths(RootObject, TargetObjects, LeafObject, Direction);
+
+	const auto From = Direction == ECrvDirection::Outgoing ? RootObject : LeafObject;
+	const auto To = Direction == ECrvDirection::Outgoing ? LeafObject : RootObject;
+	auto Description = FString::Printf(TEXT("%s -> %s"), *GetDebugName(From), *GetDebugName(To));
+	if (Paths.IsEmpty())
+	{
+		Description += TEXT("\n(not held by a property)");
+	}
+	for (const auto& Path : Paths)
+	{
+		Description += FString::Printf(TEXT("\n%s"), *Path);
+	}
+	return Description;
+}
+
+FString FCrvRefSearch::DescribeUnloadedReference(const UObject* RootObject, const FName LeafLabel, const FSoftObjectPath& LeafPath, const ECrvDirection Direction)
+{
+	if (!IsValid(RootObject)) { return FString(); }
+	// the properties holding the reference are only known once the actor is loaded
+	const auto RootName = GetDebugName(RootObject);
+	const auto LeafName = FString::Printf(TEXT("%s (unloaded)"), *LeafLabel.ToString());
+	const auto& From = Direction == ECrvDirection::Outgoing ? RootName : LeafName;
+	const auto& To = Direction == ECrvDirection::Outgoing ? LeafName : RootName;
+	return FString::Printf(TEXT("%s -> %s\n%s"), *From, *To, *LeafPath.ToString());
+}
+
 bool IsObjectProperty(const FProperty* InProperty)
 {
 	return CastField<FObjectPropertyBase>(InProperty) != nullptr;
@@ -335,6 +493,10 @@ bool FCrvRefSearch::CanDisplayReference(const UObject* RootObject, const UObject
 
 FCrvSet FCrvRefSearch::GetSelectionSet()
 {
+	if (const auto Subsystem = GEditor ? GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>() : nullptr)
+	{
+		return Subsystem->SelectionTracker.GetSelection();
+	}
 	TArray<UObject*> SelectedActors;
 	TArray<UObject*> SelectedComponents;
 	GEditor->GetSelectedActors()->GetSelectedObjects(SelectedActors);
@@ -356,18 +518,29 @@ static auto GetCanDisplayReference(UObject* RootObject)
 	};
 }
 
+static TArray<UObject*> FilterReferences(UObject* RootObject, const TArray<UObject*>& References)
+{
+	CRV_TRACE_SCOPE("Crv::FilterReferences");
+	auto Filtered = References.FilterByPredicate(GetCanDisplayReference(RootObject));
+	TRACE_COUNTER_ADD(CrvFilteredRefs, References.Num() - Filtered.Num());
+	return Filtered;
+}
+
 FCrvSet Search::FindTargetObjects(UObject* RootObject)
 {
 	static FCrvSet Empty;
 	if (!IsValid(RootObject)) { return Empty; }
+	CRV_TRACE_SCOPE("Crv::FindTargetObjects");
 	FCrvSet TargetObjects;
 	TargetObjects.Append(Search::FindOwnedObjects(RootObject));
 	TargetObjects.Add(RootObject);
+	TRACE_COUNTER_ADD(CrvTargetObjects, TargetObjects.Num());
 	return MoveTemp(TargetObjects);
 }
 
 void FCrvRefSearch::FindOutRefs(FCrvSet RootObjects, FCrvObjectGraph& Graph)
 {
+	CRV_TRACE_SCOPE("Crv::FindOutRefs");
 	auto* const CrvSettings = GetDefault<UCrvSettings>();
 	Graph.Reserve(RootObjects.Num());
 	Graph.Reset();
@@ -387,13 +560,13 @@ void FCrvRefSearch::FindOutRefs(FCrvSet RootObjects, FCrvObjectGraph& Graph)
 				CrvSettings->bIgnoreTransient
 			);
 			RefFinder.FindReferences(TargetObject);
-			RootObjectReferences.Append(NewItemsArray.FilterByPredicate(GetCanDisplayReference(RootObject)));
+			RootObjectReferences.Append(FilterReferences(RootObject, NewItemsArray));
 		}
 		for (const auto TargetObject : TargetObjects)
 		{
 			if (CrvSettings->bWalkObjectProperties)
 			{
-				RootObjectReferences.Append(Search::FindSoftObjectReferences(TargetObject).FilterByPredicate(GetCanDisplayReference(RootObject)));
+				RootObjectReferences.Append(FilterReferences(RootObject, Search::FindSoftObjectReferences(TargetObject)));
 			}
 		}
 		Graph.Add(RootObject, RootObjectReferences);
@@ -426,12 +599,61 @@ bool ChainContains(const FReferenceChainSearch::FReferenceChain* Chain, const UO
 
 void FCrvRefSearch::FindInRefs(FCrvSet RootObjects, FCrvObjectGraph& Graph)
 {
+	CRV_TRACE_SCOPE("Crv::FindInRefs");
 	Graph.Reserve(RootObjects.Num());
 	for (auto RootObject : RootObjects)
 	{
 		auto TargetObjects = Search::FindTargetObjects(RootObject);
 		auto Referencers = FReferencerFinder::GetAllReferencers(TargetObjects, nullptr, EReferencerFinderFlags::SkipInnerReferences);
-		auto Filtered = Referencers.FilterByPredicate(GetCanDisplayReference(RootObject));
+		auto Filtered = FilterReferences(RootObject, Referencers);
 		Graph.Add(RootObject, TSet(Filtered));
 	}
+}
+
+void FCrvRefSearch::FindInRefsBatched(FCrvSet RootObjects, FCrvObjectGraph& Graph)
+{
+	CRV_TRACE_SCOPE("Crv::FindInRefsBatched");
+	Graph.Reserve(RootObjects.Num());
+	// a target can be owned by more than one root
+	TMap<UObject*, TArray<UObject*, TInlineAllocator<1>>> RootsByTarget;
+	TArray<UObject*> AllTargets;
+	for (auto RootObject : RootObjects)
+	{
+		for (const auto TargetObject : Search::FindTargetObjects(RootObject))
+		{
+			auto& Roots = RootsByTarget.FindOrAdd(TargetObject);
+			if (Roots.IsEmpty())
+			{
+				AllTargets.Add(TargetObject);
+			}
+			Roots.Add(RootObject);
+		}
+		Graph.Add(RootObject);
+	}
+	if (AllTargets.IsEmpty()) { return; }
+
+	const auto Referencers = FReferencerFinder::GetAllReferencers(AllTargets, nullptr, EReferencerFinderFlags::SkipInnerReferences);
+
+	TMap<UObject*, FCrvSet> ReferencersByRoot;
+	for (const auto Referencer : Referencers)
+	{
+		// direct references only, the same edges GetAllReferencers followed
+		TArray<UObject*> Referenced;
+		FReferenceFinder RefFinder(Referenced, nullptr, false, false, false, false);
+		RefFinder.FindReferences(Referencer);
+		for (const auto Target : Referenced)
+		{
+			const auto Roots = RootsByTarget.Find(Target);
+			// SkipInnerReferences is applied per referenced target
+			if (!Roots || Referencer == Target || Referencer->IsIn(Target)) { continue; }
+			for (const auto Root : *Roots)
+			{
+				ReferencersByRoot.FindOrAdd(Root).Add(Referencer);
+			}
+		}
+	}
+	for (auto& [RootObject, RootReferencers] : ReferencersByRoot)
+	{
+		Graph.FindChecked(RootObject).Append(FilterReferences(RootObject, RootReferencers.Array()));
+	}
 }
\ No newline at end of file
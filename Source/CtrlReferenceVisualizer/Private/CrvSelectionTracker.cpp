@@ -0,0 +1,143 @@
+#include "CrvSelectionTracker.h"
+
+#include "CrvTrace.h"
+#include "CtrlReferenceVisualizer.h"
+#include "Editor.h"
+#include "Selection.h"
+#include "TimerManager.h"
+
+void FCrvSelectionTracker::Register()
+{
+	SelectionChangedHandle = USelection::SelectionChangedEvent.AddRaw(this, &FCrvSelectionTracker::OnSelectionChanged);
+	SelectObjectHandle = USelection::SelectObjectEvent.AddRaw(this, &FCrvSelectionTracker::OnSelectObject);
+	bActorsDirty = true;
+	bComponentsDirty = true;
+}
+
+void FCrvSelectionTracker::Unregister()
+{
+	USelection::SelectionChangedEvent.Remove(SelectionChangedHandle);
+	USelection::SelectObjectEvent.Remove(SelectObjectHandle);
+	if (GEditor)
+	{
+		GEditor->GetTimerManager()->ClearTimer(FlushHandle);
+	}
+	bFlushScheduled = false;
+	Actors.Reset();
+	Components.Reset();
+	Touched.Reset();
+}
+
+FCrvSet FCrvSelectionTracker::GetSelection()
+{
+	Flush();
+	FCrvSet Selection = ResolveWeakSet(Actors);
+	Selection.Append(ResolveWeakSet(Components));
+	return MoveTemp(Selection);
+}
+
+void FCrvSelectionTracker::OnSelectionChanged(UObject* SelectionObject)
+{
+	if (!GEditor) { return; }
+	if (SelectionObject == GEditor->GetSelectedActors())
+	{
+		bActorsDirty = true;
+	}
+	else if (SelectionObject == GEditor->GetSelectedComponents())
+	{
+		bComponentsDirty = true;
+	}
+	else
+	{
+		return;
+	}
+	ScheduleFlush();
+}
+
+void FCrvSelectionTracker::OnSelectObject(UObject* Object)
+{
+	if (!Object || !(Object->IsA<AActor>() || Object->IsA<UActorComponent>())) { return; }
+	Touched.Add(Object);
+	ScheduleFlush();
+}
+
+void FCrvSelectionTracker::ScheduleFlush()
+{
+	if (!GEditor || bFlushScheduled) { return; }
+	bFlushScheduled = true;
+	FlushHandle = GEditor->GetTimerManager()->SetTimerForNextTick([this]() { Flush(); });
+}
+
+void FCrvSelectionTracker::Diff(USelection* Selection, TSet<TWeakObjectPtr<UObject>>& Tracked, FCrvSet& Added, FCrvSet& Removed)
+{
+	TArray<UObject*> SelectedArray;
+	Selection->GetSelectedObjects(SelectedArray);
+	TSet<TWeakObjectPtr<UObject>> Selected;
+	Selected.Reserve(SelectedArray.Num());
+	for (const auto Object : SelectedArray)
+	{
+		Selected.Add(Object);
+		if (!Tracked.Contains(Object))
+		{
+			Added.Add(Object);
+		}
+	}
+	for (const auto& Object : Tracked)
+	{
+		if (Object.IsValid() && !Selected.Contains(Object))
+		{
+			Removed.Add(Object.Get());
+		}
+	}
+	Tracked = MoveTemp(Selected);
+}
+
+void FCrvSelectionTracker::Flush()
+{
+	if (!GEditor) { return; }
+	GEditor->GetTimerManager()->ClearTimer(FlushHandle);
+	bFlushScheduled = false;
+	if (!bActorsDirty && !bComponentsDirty && Touched.IsEmpty()) { return; }
+	CRV_TRACE_SCOPE("Crv::OnSelectionChanged");
+
+	FCrvSet Added;
+	FCrvSet Removed;
+	if (bActorsDirty)
+	{
+		Diff(GEditor->GetSelectedActors(), Actors, Added, Removed);
+	}
+	if (bComponentsDirty)
+	{
+		Diff(GEditor->GetSelectedComponents(), Components, Added, Removed);
+	}
+	for (const auto& WeakObject : Touched)
+	{
+		const auto Object = WeakObject.Get();
+		if (!Object) { continue; }
+		const bool bIsActor = Object->IsA<AActor>();
+		// already diffed
+		if (bIsActor ? bActorsDirty : bComponentsDirty) { continue; }
+		auto& Tracked = bIsActor ? Actors : Components;
+		const auto Selection = bIsActor ? GEditor->GetSelectedActors() : GEditor->GetSelectedComponents();
+		if (Selection->IsSelected(Object))
+		{
+			if (!Tracked.Contains(Object))
+			{
+				Tracked.Add(Object);
+				Added.Add(Object);
+			}
+		}
+		else if (Tracked.Remove(Object) > 0)
+		{
+			Removed.Add(Object);
+		}
+	}
+	bActorsDirty = false;
+	bComponentsDirty = false;
+	Touched.Reset();
+
+	if (Added.IsEmpty() && Removed.IsEmpty()) { return; }
+	const CtrlRefViz::Trace::FPassScope Pass(TEXT("Selection"));
+	UE_CLOG(FCrvModule::IsDebugEnabled(), LogCrv, Log, TEXT("Selection changed: Pass: %u, %d added, %d removed"), Pass.PassId, Added.Num(), Removed.Num());
+	OnSelectionDelta.Broadcast(Added, Removed);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CrvUtils.h"
+
+class USelection;
+
+/**
+ * Keeps the set of selected actors & components up to date from selection events.
+ * Events are merged & applied once per tick, so a marquee or group selection produces a single delta.
+ * Individually selected objects are applied as they are, a selection changed without knowing which
+ * objects (e.g. select none, batch operations) is diffed against the tracked set once.
+ */
+class FCrvSelectionTracker
+{
+public:
+	void Register();
+	void Unregister();
+
+	// Applies any pending events first
+	FCrvSet GetSelection();
+	void Flush();
+
+	DECLARE_MULTICAST_DELEGATE_TwoParams(FOnSelectionDelta, const FCrvSet& /*Added*/, const FCrvSet& /*Removed*/)
+	FOnSelectionDelta OnSelectionDelta;
+
+private:
+	void OnSelectionChanged(UObject* SelectionObject);
+	void OnSelectObject(UObject* Object);
+	void ScheduleFlush();
+	static void Diff(USelection* Selection, TSet<TWeakObjectPtr<UObject>>& Tracked, FCrvSet& Added, FCrvSet& Removed);
+
+	TSet<TWeakObjectPtr<UObject>> Actors;
+	TSet<TWeakObjectPtr<UObject>> Components;
+	// objects selected or deselected since the last flush
+	TSet<TWeakObjectPtr<UObject>> Touched;
+	bool bActorsDirty = true;
+	bool bComponentsDirty = true;
+	bool bFlushScheduled = false;
+
+	FTimerHandle FlushHandle;
+	FDelegateHandle SelectionChangedHandle;
+	FDelegateHandle SelectObjectHandle;
+};
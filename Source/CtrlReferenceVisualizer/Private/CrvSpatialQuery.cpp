@@ -0,0 +1,203 @@
+#include "CrvSpatialQuery.h"
+
+#include "CrvLocationCache.h"
+#include "CrvRefSearch.h"
+#include "CrvSettings.h"
+#include "CrvTrace.h"
+#include "CtrlReferenceVisualizer.h"
+
+#include "Engine/World.h"
+
+#include "GameFramework/Actor.h"
+
+#include "UObject/UObjectGlobals.h"
+
+#include "WorldPartition/DataLayer/DataLayerInstance.h"
+
+namespace CtrlRefViz::Spatial
+{
+	// resolved once per actor, edges compare these
+	struct FEndpoint
+	{
+		FVector Location = FVector::ZeroVector;
+		FIntPoint Cell = FIntPoint::ZeroValue;
+		bool bIsSpatiallyLoaded = false;
+		TArray<const UDataLayerInstance*> DataLayers;
+	};
+
+	static FIntPoint GetCell(const FVector& Location, const double CellSize)
+	{
+		return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+	}
+
+	// Actors hard referenced by Actor & its subobjects, soft & weak references don't keep the target loaded
+	static TSet<const AActor*> FindHardReferencedActors(AActor* Actor)
+	{
+		const auto CrvSettings = GetDefault<UCrvSettings>();
+		TArray<UObject*> Found;
+		for (const auto TargetObject : Search::FindTargetObjects(Actor))
+		{
+			FReferenceFinder RefFinder(Found, nullptr, false, CrvSettings->bIgnoreArchetype, CrvSettings->bIsRecursive, CrvSettings->bIgnoreTransient);
+			RefFinder.FindReferences(TargetObject);
+		}
+		TSet<const AActor*> Actors;
+		for (const auto Object : Found)
+		{
+			Actors.Add(GetOwner(Object));
+		}
+		return Actors;
+	}
+}
+
+FCrvSpatialQueryParams FCrvSpatialQueryParams::FromSettings(const UCrvSettings* Config)
+{
+	FCrvSpatialQueryParams Params;
+	// settings are in meters
+	Params.MaxDistance = Config->SpatialMaxDistance * 100.0;
+	Params.CellSize = Config->SpatialCellSize * 100.0;
+	Params.bCheckDataLayers = Config->bSpatialCheckDataLayers;
+	return Params;
+}
+
+void FCrvSpatialQuery::Build(UWorld* World, const FCrvObjectGraph& Outgoing, const FCrvObjectGraph& Incoming, FCrvLocationCache& Locations, const FCrvSpatialQueryParams& Params)
+{
+	using namespace CtrlRefViz::Spatial;
+	CRV_TRACE_SCOPE("Crv::SpatialQuery");
+	Reset();
+	// cells & data layers only stream in partitioned worlds
+	const bool bIsPartitioned = World && World->IsPartitionedWorld();
+	const bool bCheckCells = bIsPartitioned && Params.CellSize > 0.0;
+	const bool bCheckDataLayers = bIsPartitioned && Params.bCheckDataLayers;
+
+	TMap<const AActor*, FEndpoint> Endpoints;
+	auto GetEndpoint = [&](const AActor* Actor) -> const FEndpoint&
+	{
+		if (const auto Found = Endpoints.Find(Actor))
+		{
+			return *Found;
+		}
+		FEndpoint Endpoint;
+		Endpoint.Location = Locations.GetLocation(Actor);
+		if (bCheckCells)
+		{
+			Endpoint.Cell = GetCell(Endpoint.Location, Params.CellSize);
+			Endpoint.bIsSpatiallyLoaded = Actor->GetIsSpatiallyLoaded();
+		}
+		if (bCheckDataLayers)
+		{
+			Endpoint.DataLayers = Actor->GetDataLayerInstances();
+		}
+		return Endpoints.Add(Actor, MoveTemp(Endpoint));
+	};
+
+	// components of the same actors reference each other many times, check each actor pair once
+	TSet<TPair<const AActor*, const AActor*>> Visited;
+	auto AddCandidate = [&](const UObject* SourceObject, const UObject* TargetObject)
+	{
+		const auto Source = GetOwner(SourceObject);
+		const auto Target = GetOwner(TargetObject);
+		if (!IsValid(Source) || !IsValid(Target) || Source == Target) { return; }
+		bool bIsVisited = false;
+		Visited.Add({Source, Target}, &bIsVisited);
+		if (bIsVisited) { return; }
+
+		// adding the target can reallocate the map, look the source up after
+		GetEndpoint(Source);
+		const auto& TargetEndpoint = GetEndpoint(Target);
+		const auto& SourceEndpoint = Endpoints.FindChecked(Source);
+		const double Distance = FVector::Distance(SourceEndpoint.Location, TargetEndpoint.Location);
+		auto Issues = ECrvSpatialIssue::None;
+		if (Params.MaxDistance > 0.0 && Distance > Params.MaxDistance)
+		{
+			Issues |= ECrvSpatialIssue::LongDistance;
+		}
+		// always loaded targets can't be streamed out from under the source
+		if (bCheckCells && TargetEndpoint.bIsSpatiallyLoaded && (!SourceEndpoint.bIsSpatiallyLoaded || SourceEndpoint.Cell != TargetEndpoint.Cell))
+		{
+			Issues |= ECrvSpatialIssue::CrossCell;
+		}
+		if (bCheckDataLayers && TargetEndpoint.DataLayers.ContainsByPredicate([&](const UDataLayerInstance* Layer) { return !SourceEndpoint.DataLayers.Contains(Layer); }))
+		{
+			Issues |= ECrvSpatialIssue::CrossDataLayer;
+		}
+		if (Issues == ECrvSpatialIssue::None) { return; }
+		Edges.Add({const_cast<AActor*>(Source), const_cast<AActor*>(Target), Distance, Issues});
+	};
+	for (const auto& [Root, Leaves] : Outgoing)
+	{
+		for (const auto Leaf : Leaves)
+		{
+			AddCandidate(Root, Leaf);
+		}
+	}
+	for (const auto& [Root, Leaves] : Incoming)
+	{
+		for (const auto Leaf : Leaves)
+		{
+			AddCandidate(Leaf, Root);
+		}
+	}
+
+	// the cache also holds soft references, only hard ones keep the target loaded
+	// only the few candidates are searched again, once per source actor
+	TMap<const AActor*, TSet<const AActor*>> HardReferences;
+	Edges.RemoveAll([&](const FCrvSpatialEdge& Edge)
+	{
+		const auto Source = Edge.Source.Get();
+		auto* Found = HardReferences.Find(Source);
+		if (!Found)
+		{
+			Found = &HardReferences.Add(Source, FindHardReferencedActors(Source));
+		}
+		return !Found->Contains(Edge.Target.Get());
+	});
+
+	Edges.Sort([](const FCrvSpatialEdge& A, const FCrvSpatialEdge& B) { return A.Distance > B.Distance; });
+	for (int32 Index = 0; Index < Edges.Num(); ++Index)
+	{
+		EdgesByActor.Add(Edges[Index].Source.Get(), Index);
+		EdgesByActor.Add(Edges[Index].Target.Get(), Index);
+	}
+	UE_CLOG(FCrvModule::IsDebugEnabled(), LogCrv, Log, TEXT("SpatialQuery: %d edges of %d actors"), Edges.Num(), Endpoints.Num());
+}
+
+void FCrvSpatialQuery::Reset()
+{
+	Edges.Reset();
+	EdgesByActor.Reset();
+}
+
+void FCrvSpatialQuery::GetEdgesOf(const AActor* Actor, TArray<const FCrvSpatialEdge*>& OutEdges) const
+{
+	for (auto It = EdgesByActor.CreateConstKeyIterator(Actor); It; ++It)
+	{
+		OutEdges.Add(&Edges[It.Value()]);
+	}
+}
+
+void FCrvSpatialQuery::Log(const int32 MaxEdges) const
+{
+	UE_LOG(LogCrv, Display, TEXT("References that can break streaming: %d"), Edges.Num());
+	for (int32 Index = 0; Index < FMath::Min(MaxEdges, Edges.Num()); ++Index)
+	{
+		const auto& Edge = Edges[Index];
+		UE_LOG(
+			LogCrv,
+			Display,
+			TEXT("\t%.1fm %s -> %s (%s)"),
+			Edge.Distance / 100.0,
+			*GetDebugName(Edge.Source.Get()),
+			*GetDebugName(Edge.Target.Get()),
+			*DescribeIssues(Edge.Issues)
+		);
+	}
+}
+
+FString FCrvSpatialQuery::DescribeIssues(const ECrvSpatialIssue Issues)
+{
+	TArray<FString> Names;
+	if (EnumHasAnyFlags(Issues, ECrvSpatialIssue::LongDistance)) { Names.Add(TEXT("long distance")); }
+	if (EnumHasAnyFlags(Issues, ECrvSpatialIssue::CrossCell)) { Names.Add(TEXT("cross cell")); }
+	if (EnumHasAnyFlags(Issues, ECrvSpatialIssue::CrossDataLayer)) { Names.Add(TEXT("cross data layer")); }
+	return FString::Join(Names, TEXT(", "));
+}
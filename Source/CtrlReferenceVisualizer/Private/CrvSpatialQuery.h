@@ -0,0 +1,64 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CrvUtils.h"
+#include "UObject/ObjectKey.h"
+
+class FCrvLocationCache;
+class UCrvSettings;
+
+enum class ECrvSpatialIssue : uint8
+{
+	None = 0,
+	// endpoints are further apart than MaxDistance
+	LongDistance = 1 << 0,
+	// the referenced actor streams in a different World Partition cell
+	CrossCell = 1 << 1,
+	// the referenced actor is in data layers the referencer isn't in
+	CrossDataLayer = 1 << 2,
+};
+ENUM_CLASS_FLAGS(ECrvSpatialIssue)
+
+// A hard reference between two actors that can break streaming
+struct FCrvSpatialEdge
+{
+	TWeakObjectPtr<AActor> Source;
+	TWeakObjectPtr<AActor> Target;
+	double Distance = 0.0;
+	ECrvSpatialIssue Issues = ECrvSpatialIssue::None;
+};
+
+struct FCrvSpatialQueryParams
+{
+	// in cm, 0 to skip the distance check
+	double MaxDistance = 0.0;
+	// in cm, size of the streaming grid cells, 0 to skip the cell check
+	double CellSize = 0.0;
+	bool bCheckDataLayers = true;
+
+	static FCrvSpatialQueryParams FromSettings(const UCrvSettings* Config);
+};
+
+/**
+ * Finds cached references whose endpoints are far apart, or stream in different cells or data layers.
+ * Endpoint locations come from the location cache and are bucketed into the streaming grid once per actor.
+ * Edges are ranked longest first.
+ */
+class FCrvSpatialQuery
+{
+public:
+	// Outgoing & incoming graphs as cached, components & subobjects are resolved to their owning actor
+	void Build(UWorld* World, const FCrvObjectGraph& Outgoing, const FCrvObjectGraph& Incoming, FCrvLocationCache& Locations, const FCrvSpatialQueryParams& Params);
+	void Reset();
+
+	const TArray<FCrvSpatialEdge>& GetEdges() const { return Edges; }
+	// Edges from or to Actor
+	void GetEdgesOf(const AActor* Actor, TArray<const FCrvSpatialEdge*>& OutEdges) const;
+	void Log(int32 MaxEdges) const;
+
+	static FString DescribeIssues(ECrvSpatialIssue Issues);
+
+private:
+	TArray<FCrvSpatialEdge> Edges;
+	TMultiMap<TObjectKey<AActor>, int32> EdgesByActor;
+};
@@ -0,0 +1,51 @@
+#include "CrvTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(CrvChannel);
+
+TRACE_DECLARE_INT_COUNTER(CrvPass, TEXT("CtrlReferenceVisualizer/Pass"));
+TRACE_DECLARE_INT_COUNTER(CrvDrawnPass, TEXT("CtrlReferenceVisualizer/DrawnPass"));
+TRACE_DECLARE_INT_COUNTER(CrvRootObjects, TEXT("CtrlReferenceVisualizer/RootObjects"));
+TRACE_DECLARE_INT_COUNTER(CrvTargetObjects, TEXT("CtrlReferenceVisualizer/TargetObjects"));
+TRACE_DECLARE_INT_COUNTER(CrvFilteredRefs, TEXT("CtrlReferenceVisualizer/FilteredRefs"));
+TRACE_DECLARE_INT_COUNTER(CrvOutgoingRefs, TEXT("CtrlReferenceVisualizer/OutgoingRefs"));
+TRACE_DECLARE_INT_COUNTER(CrvIncomingRefs, TEXT("CtrlReferenceVisualizer/IncomingRefs"));
+TRACE_DECLARE_INT_COUNTER(CrvSceneProxies, TEXT("CtrlReferenceVisualizer/SceneProxies"));
+TRACE_DECLARE_INT_COUNTER(CrvSceneProxyLines, TEXT("CtrlReferenceVisualizer/SceneProxyLines"));
+
+namespace CtrlRefViz::Trace
+{
+	static uint32 PassId = 0;
+	// open BeginPass calls, the pass closes when it drops to 0
+	static int32 PassDepth = 0;
+}
+
+uint32 CtrlRefViz::Trace::BeginPass(const TCHAR* Reason)
+{
+	check(IsInGameThread());
+	if (PassDepth++ > 0) { return PassId; }
+	++PassId;
+	TRACE_COUNTER_SET(CrvPass, PassId);
+	TRACE_COUNTER_SET(CrvRootObjects, 0);
+	TRACE_COUNTER_SET(CrvTargetObjects, 0);
+	TRACE_COUNTER_SET(CrvFilteredRefs, 0);
+	TRACE_COUNTER_SET(CrvOutgoingRefs, 0);
+	TRACE_COUNTER_SET(CrvIncomingRefs, 0);
+	TRACE_COUNTER_SET(CrvSceneProxies, 0);
+	TRACE_COUNTER_SET(CrvSceneProxyLines, 0);
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(CrvChannel))
+	{
+		TRACE_BOOKMARK(TEXT("Crv Pass %u: %s"), PassId, Reason);
+	}
+	return PassId;
+}
+
+void CtrlRefViz::Trace::EndPass()
+{
+	check(IsInGameThread() && PassDepth > 0);
+	--PassDepth;
+}
+
+uint32 CtrlRefViz::Trace::GetPassId()
+{
+	return PassId;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/MiscTrace.h"
+#include "Trace/Trace.h"
+
+// Select-to-draw pipeline scopes, record with -trace=cpu,counters,bookmark,CrvChannel
+UE_TRACE_CHANNEL_EXTERN(CrvChannel);
+
+#define CRV_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(Name, CrvChannel)
+
+// id of the update pass being processed, & the pass drawn by the render thread
+TRACE_DECLARE_INT_COUNTER_EXTERN(CrvPass);
+TRACE_DECLARE_INT_COUNTER_EXTERN(CrvDrawnPass);
+// per pass totals, reset when a pass begins
+TRACE_DECLARE_INT_COUNTER_EXTERN(CrvRootObjects);
+TRACE_DECLARE_INT_COUNTER_EXTERN(CrvTargetObjects);
+TRACE_DECLARE_INT_COUNTER_EXTERN(CrvFilteredRefs);
+TRACE_DECLARE_INT_COUNTER_EXTERN(CrvOutgoingRefs);
+TRACE_DECLARE_INT_COUNTER_EXTERN(CrvIncomingRefs);
+TRACE_DECLARE_INT_COUNTER_EXTERN(CrvSceneProxies);
+TRACE_DECLARE_INT_COUNTER_EXTERN(CrvSceneProxyLines);
+
+namespace CtrlRefViz::Trace
+{
+	/**
+	 * Correlation id for one update pass, from a selection change or scheduled update to the cache broadcast.
+	 * Requests made while a pass is open join it, so a selection can be followed end to end in Insights.
+	 * Every BeginPass must be matched by an EndPass, the pass closes with the last one. Game thread only.
+	 */
+	uint32 BeginPass(const TCHAR* Reason);
+	// Proxies created after the pass closes still report its id
+	void EndPass();
+	uint32 GetPassId();
+
+	// Holds a pass open for its lifetime
+	struct FPassScope
+	{
+		explicit FPassScope(const TCHAR* Reason)
+			: PassId(BeginPass(Reason)) {}
+
+		~FPassScope() { EndPass(); }
+
+		FPassScope(const FPassScope&) = delete;
+		FPassScope& operator=(const FPassScope&) = delete;
+
+		const uint32 PassId;
+	};
+}
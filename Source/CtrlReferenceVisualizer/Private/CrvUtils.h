@@ -116,4 +116,14 @@ namespace CtrlRefViz
 		}
 		return MoveTemp(Out);
 	}
+
+	inline int32 CountEdges(const FCrvObjectGraph& Graph)
+	{
+		int32 Num = 0;
+		for (const auto& [Object, Set] : Graph)
+		{
+			Num += Set.Num();
+		}
+		return Num;
+	}
 }
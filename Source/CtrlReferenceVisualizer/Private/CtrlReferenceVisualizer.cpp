@@ -1,6 +1,8 @@
 ﻿#include "CtrlReferenceVisualizer.h"
 
+#include "CrvClassInfoCache.h"
 #include "CrvCommands.h"
+#include "CrvLinePicker.h"
 #include "CrvRefSearch.h"
 #include "CrvSettings.h"
 #include "CrvStyle.h"
@@ -8,16 +10,69 @@
 #include "ISettingsModule.h"
 #include "LevelEditorSubsystem.h"
 #include "ObjectEditorUtils.h"
+#include "SCrvReferenceExplorer.h"
+
+#include "Algo/Sort.h"
 
 #include "Styling/SlateIconFinder.h"
 
 #include "UObject/Object.h"
 
+#include "Widgets/Docking/SDockTab.h"
+
 #define LOCTEXT_NAMESPACE "ReferenceVisualizer"
 using namespace CtrlRefViz;
 
 DEFINE_LOG_CATEGORY(LogCrv);
 
+const FName FCrvModule::ExplorerTabName(TEXT("CtrlReferenceExplorer"));
+
+namespace CtrlRefViz::Menu
+{
+	// references listed per submenu page, the rest are behind a "next" submenu that is only built when opened
+	constexpr int32 PageSize = 100;
+
+	struct FCrvMenuRef
+	{
+		TWeakObjectPtr<UObject> Parent;
+		TWeakObjectPtr<UObject> Object;
+		FString SortKey;
+	};
+
+	void MakeReferenceListPage(UToolMenu* Menu, const TSharedRef<const TArray<FCrvMenuRef>>& Refs, const int32 Start)
+	{
+		const int32 End = FMath::Min(Start + PageSize, Refs->Num());
+		for (int32 Index = Start; Index < End; ++Index)
+		{
+			const auto& MenuRef = (*Refs)[Index];
+			const auto Ref = MenuRef.Object.Get();
+			if (!Ref) { continue; }
+
+			const auto ClassInfo = FCrvModule::Get().GetClassInfo(Ref->GetClass());
+			FToolMenuSection& Section = Menu->FindOrAddSection(ClassInfo.SectionName);
+			Section.Label = ClassInfo.Label;
+			auto [Name, Label, ToolTip, Icon, Action] = FCrvRefSearch::MakeMenuEntry(MenuRef.Parent.Get(), Ref);
+			const auto ToolEntry = FToolMenuEntry::InitMenuEntry(Name, Label, ToolTip, Icon, Action);
+			Section.AddEntry(ToolEntry);
+		}
+
+		const int32 Remaining = Refs->Num() - End;
+		if (Remaining <= 0) { return; }
+		const auto NextPage = FToolMenuEntry::InitSubMenu(
+			FName("CtrlReferenceVisualizer_NextPage"),
+			FText::Format(LOCTEXT("NextPage", "Next {0}..."), FText::AsNumber(FMath::Min(Remaining, PageSize))),
+			FText::Format(LOCTEXT("NextPageTooltip", "{0} more references"), FText::AsNumber(Remaining)),
+			FNewToolMenuDelegate::CreateLambda(
+				[Refs, End](UToolMenu* NextMenu)
+				{
+					MakeReferenceListPage(NextMenu, Refs, End);
+				}
+			)
+		);
+		Menu->FindOrAddSection(FName("CtrlReferenceVisualizer_Paging")).AddEntry(NextPage);
+	}
+}
+
 void FCrvModule::MakeReferenceListSubMenu(UToolMenu* SubMenu, const ECrvDirection Direction) const
 {
 	if (!GetDefault<UCrvSettings>()->IsEnabled())
@@ -35,47 +90,30 @@ void FCrvModule::MakeReferenceListSubMenu(UToolMenu* SubMenu, const ECrvDirectio
 	auto CrvEditorSubsystem = GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>();
 	auto MenuCache = CrvEditorSubsystem->MenuCache;
 	MenuCache->FillCache(FCrvRefSearch::GetSelectionSet());
+	// flags & outers may have changed since the menu was last opened
+	FCrvRefSearch::ResetToolTips();
 
-	bool bFoundEntry = false;
+	const auto Refs = MakeShared<TArray<Menu::FCrvMenuRef>>();
 	FCrvSet Visited;
-	auto ValidCache = MenuCache->GetValidCached(Direction);
 	for (auto SelectedObject : FCrvRefSearch::GetSelectionSet())
 	{
 		if (!SelectedObject) { return; }
 		UE_CLOG(IsDebugEnabled(), LogCrv, Log, TEXT("Find %s for SelectedObject: %s"), *SelectedObject->GetFullName(), Direction == ECrvDirection::Outgoing ? TEXT("Outgoing") : TEXT("Incoming"));
-		auto Refs = MenuCache->GetReferences(SelectedObject, Direction);
-		if (!Refs.Num()) { continue; }
+		auto SelectedRefs = MenuCache->GetReferences(SelectedObject, Direction);
+		if (!SelectedRefs.Num()) { continue; }
 
-		auto RefsArray = Refs.Array();
-		RefsArray.Sort(
-			[](const UObject& A, const UObject& B) { return A.GetFullName().Compare(B.GetFullName()) < 0; }
-		);
-		for (auto Ref : RefsArray)
+		// build each sort key once rather than twice per comparison
+		const int32 FirstIndex = Refs->Num();
+		for (auto Ref : SelectedRefs)
 		{
 			if (Visited.Contains(Ref)) { continue; }
-
-			FToolMenuSection& Section = SubMenu->FindOrAddSection(FName(Ref->GetClass()->GetPathName()));
-			FToolMenuSection* SectionPtr = &Section;
-			if (auto BP = UBlueprint::GetBlueprintFromClass(Ref->GetClass()->GetAuthoritativeClass()))
-			{
-				auto& Section2 = SubMenu->FindOrAddSection(FName(BP->GetFullName()));
-				SectionPtr = &Section2;
-				// get human-readable name from uobject
-				SectionPtr->Label = FText::FromString(BP->GetFriendlyName());
-			}
-			else
-			{
-				SectionPtr->Label = FText::FromString(Ref->GetClass()->GetName());
-			}
-			auto [Name, Label, ToolTip, Icon, Action] = FCrvRefSearch::MakeMenuEntry(SelectedObject, Ref);
-			const auto ToolEntry = FToolMenuEntry::InitMenuEntry(Name, Label, ToolTip, Icon, Action);
-			SectionPtr->AddEntry(ToolEntry);
-			bFoundEntry = true;
+			Refs->Add({SelectedObject, Ref, Ref->GetFullName()});
 		}
-		Visited.Append(Refs);
+		Algo::SortBy(MakeArrayView(Refs->GetData() + FirstIndex, Refs->Num() - FirstIndex), &Menu::FCrvMenuRef::SortKey);
+		Visited.Append(SelectedRefs);
 	}
 
-	if (!bFoundEntry)
+	if (Refs->IsEmpty())
 	{
 		const auto ToolEntry = FToolMenuEntry::InitMenuEntry(
 			FName("CtrlReferenceVisualizer_None"),
@@ -85,7 +123,9 @@ void FCrvModule::MakeReferenceListSubMenu(UToolMenu* SubMenu, const ECrvDirectio
 			FUIAction()
 		);
 		SubMenu->AddMenuEntry(FName("CtrlReferenceVisualizer_None"), ToolEntry);
+		return;
 	}
+	Menu::MakeReferenceListPage(SubMenu, Refs, 0);
 }
 
 void FCrvModule::SelectReference(UObject* Object)
@@ -378,6 +418,24 @@ void FCrvModule::InitLevelMenus() const
 						)
 					);
 
+					SubMenu->AddMenuEntry(
+						MenuSection.Name,
+						FToolMenuEntry::InitMenuEntry(
+							FName("CtrlReferenceExplorer"),
+							LOCTEXT("CrvExplorerTitle", "Reference Explorer"),
+							LOCTEXT("CrvExplorerTooltip", "Browse incoming & outgoing references of the selection"),
+							FSlateIcon(),
+							FUIAction(
+								FExecuteAction::CreateLambda(
+									[]()
+									{
+										FGlobalTabmanager::Get()->TryInvokeTab(ExplorerTabName);
+									}
+								)
+							)
+						)
+					);
+
 					SubMenu->AddMenuEntry(MenuSection.Name, FToolMenuEntry::InitSeparator(NAME_None));
 					SubMenu->AddMenuEntry(MenuSection.Name, GetSettingsMenuEntry());
 				}
@@ -388,64 +446,25 @@ void FCrvModule::InitLevelMenus() const
 	InNewToolMenu->AddMenuEntry("CtrlEditorSubmenu", ReferenceVisualizerSubMenu);
 }
 
-class SCrvDialog : public SCompoundWidget
-{
-public:
-	SLATE_BEGIN_ARGS(SCrvDialog) {}
-	SLATE_END_ARGS()
-
-	// Constructs this widget with InArgs
-	void Construct(const FArguments& InArgs);
-
-	// virtual ~SCrvDialog() override;
-};
-
-void SCrvDialog::Construct(const FArguments& InArgs)
-{
-	ChildSlot
-	[
-		SNew(SBorder)
-		.BorderImage(FAppStyle::GetBrush("DetailsView.CategoryTop"))
-		.Padding(FMargin(0.0f, 3.0f, 1.0f, 0.0f))
-		[
-			SNew(SHorizontalBox)
-			+ SHorizontalBox::Slot()
-			.FillWidth(1.0f)
-			[
-				SNew(STextBlock)
-				.Text(LOCTEXT("CtrlReferenceVisualizer", "Content"))
-			]
-		]
-	];
-	
-}
-
 void FCrvModule::InitTab()
 {
-	// create and register tab
-	const FText TitleText = LOCTEXT("CrvWindowTitle", "Ctrl Reference Visualizer");
-	// Create the window to pick the class
-	TSharedRef<SWindow>  CrvWindow = SNew(SWindow)
-		.Title(TitleText)
-		.SizingRule(ESizingRule::UserSized)
-		.ClientSize(FVector2D(1000.f, 700.f))
-		.AutoCenter(EAutoCenter::PreferredWorkArea)
-		.SupportsMinimize(false);
-	 
-	TSharedRef<SCrvDialog> Dialog = SNew(SCrvDialog);
-
-	CrvWindow->SetContent(Dialog);
-	TSharedPtr<SWindow> RootWindow = FGlobalTabmanager::Get()->GetRootWindow();
-	if (RootWindow.IsValid())
-	{
-		FSlateApplication::Get().AddWindowAsNativeChild(CrvWindow, RootWindow.ToSharedRef());
-	}
-	else
-	{
-		FSlateApplication::Get().AddWindow(CrvWindow);
-	}
-
-	
+	FGlobalTabmanager::Get()->RegisterNomadTabSpawner(
+		ExplorerTabName,
+		FOnSpawnTab::CreateLambda(
+			[](const FSpawnTabArgs& Args)
+			{
+				return SNew(SDockTab)
+					.TabRole(ETabRole::NomadTab)
+					[
+						SNew(SCrvReferenceExplorer)
+					];
+			}
+		)
+	)
+	.SetDisplayName(LOCTEXT("CrvExplorerTitle", "Reference Explorer"))
+	.SetTooltipText(LOCTEXT("CrvExplorerTooltip", "Browse incoming & outgoing references of the selection"))
+	.SetIcon(FSlateIcon(FCrvStyle::Get()->GetStyleSetName(), "Ctrl.TabIcon"))
+	.SetMenuType(ETabSpawnerMenuType::Hidden);
 }
 
 FToolMenuEntry FCrvModule::GetSettingsMenuEntry() const
@@ -473,7 +492,12 @@ void FCrvModule::OnPostEngineInit()
 	FCrvCommands::Register();
 	InitActorMenu();
 	InitLevelMenus();
+	InitTab();
 
+	LinePicker = MakeShared<FCrvLinePicker>();
+	LinePicker->Register();
+	ClassInfoCache = MakeShared<FCrvClassInfoCache>();
+	ClassInfoCache->Register();
 }
 
 void FCrvModule::StartupModule()
@@ -493,9 +517,29 @@ bool FCrvModule::IsDebugEnabled()
 	return IsEnabled() && GetDefault<UCrvSettings>()->bDebugEnabled;
 }
 
+FCrvClassInfo FCrvModule::GetClassInfo(const UClass* Class) const
+{
+	if (!ClassInfoCache.IsValid()) { return FCrvClassInfo(); }
+	return ClassInfoCache->Get(Class);
+}
+
 void FCrvModule::ShutdownModule()
 {
 	if (!UObjectInitialized()) { return; }
+	if (LinePicker.IsValid())
+	{
+		LinePicker->Unregister();
+		LinePicker.Reset();
+	}
+	if (ClassInfoCache.IsValid())
+	{
+		ClassInfoCache->Unregister();
+		ClassInfoCache.Reset();
+	}
+	if (FSlateApplication::IsInitialized())
+	{
+		FGlobalTabmanager::Get()->UnregisterNomadTabSpawner(ExplorerTabName);
+	}
 	SettingsModifiedHandle.Reset();
 	FCrvCommands::Unregister();
 	FCrvStyle::Shutdown();
@@ -1,26 +1,188 @@
 ﻿#include "ReferenceVisualizerComponent.h"
 
+#include "CrvGraphDiff.h"
+#include "CrvGraphFile.h"
+#include "CrvHitProxy.h"
 #include "CrvRefCache.h"
+#include "CrvRefSearch.h"
 #include "CrvSettings.h"
+#include "CrvSpatialQuery.h"
+#include "CrvTrace.h"
+#include "Editor.h"
+#include "EngineUtils.h"
 #include "Selection.h"
 
+#include "UObject/ObjectSaveContext.h"
+
 #if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 2
 // Added in UE 5.2
 #include "Materials/MaterialRenderProxy.h"
 #endif
 
-void UReferenceVisualizerEditorSubsystem::OnObjectModified(UObject* Object)
+namespace CtrlRefViz::Picking
 {
-	if (Cache->WeakRootObjects.Contains(Object))
+	// lines are grouped into clusters by the grid cell of their midpoint, one hit proxy per cluster
+	constexpr double ClusterCellSize = 1000.0;
+	constexpr int32 MaxLinesPerCluster = 64;
+	// lines are drawn thicker into the hit proxy buffer so they are easier to hover
+	constexpr float HitProxyLineThickness = 4.f;
+}
+
+namespace CtrlRefViz::Lines
+{
+	// vertical distance between line lanes, outgoing lines are drawn above & incoming below the actor origins
+	constexpr double LineSpacing = 10.0;
+
+	static FVector GetLaneOffset(const ECrvDirection Direction, const int32 Lane = 1)
 	{
-		Cache->Invalidate(FString::Printf(TEXT("Object modified: %s"), *GetDebugName(Object)));
+		const double Z = LineSpacing * Lane;
+		return FVector(0, 0, Direction == ECrvDirection::Outgoing ? Z : -Z);
 	}
 }
 
+namespace CrvConsoleCommands
+{
+	static UCrvRefCache* GetCache()
+	{
+		const auto Subsystem = GEditor ? GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>() : nullptr;
+		return Subsystem ? Subsystem->Cache.Get() : nullptr;
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs SaveGraph(
+		TEXT("ctrl.ReferenceVisualizer.SaveGraph"),
+		TEXT("Save the cached reference graph. Args: [File], defaults to Saved/CrvGraph/<Map>.crvg"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			const auto Cache = GetCache();
+			if (!Cache) { return; }
+			const auto Path = Args.Num() ? Args[0] : FCrvGraphFile::GetDefaultPath(World);
+			if (Cache->SaveToFile(Path))
+			{
+				UE_LOG(LogCrv, Display, TEXT("Saved reference graph to %s"), *Path);
+			}
+		})
+	);
+
+	static FAutoConsoleCommandWithWorldAndArgs LoadGraph(
+		TEXT("ctrl.ReferenceVisualizer.LoadGraph"),
+		TEXT("Replace the cached reference graph with a saved one. Args: [File], defaults to Saved/CrvGraph/<Map>.crvg"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			const auto Cache = GetCache();
+			if (!Cache) { return; }
+			const auto Path = Args.Num() ? Args[0] : FCrvGraphFile::GetDefaultPath(World);
+			if (!Cache->LoadFromFile(Path))
+			{
+				UE_LOG(LogCrv, Warning, TEXT("Could not load reference graph %s"), *Path);
+			}
+		})
+	);
+
+	static FAutoConsoleCommand DiffGraph(
+		TEXT("ctrl.ReferenceVisualizer.DiffGraph"),
+		TEXT("Log references added & removed between two saved graphs, or a saved graph & the roots in the cache. Args: <OldFile> [NewFile] [-Highlight] to also show them in the viewport"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const auto Subsystem = GEditor ? GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>() : nullptr;
+			TArray<FString> Files = Args.FilterByPredicate([](const FString& Arg) { return !Arg.StartsWith(TEXT("-")); });
+			if (!Subsystem || Files.IsEmpty()) { return; }
+			const auto OldFile = FCrvGraphFile::Open(Files[0]);
+			if (!OldFile)
+			{
+				UE_LOG(LogCrv, Warning, TEXT("Could not load reference graph %s"), *Files[0]);
+				return;
+			}
+			FCrvGraphSnapshot New;
+			if (Files.Num() > 1)
+			{
+				const auto NewFile = FCrvGraphFile::Open(Files[1]);
+				if (!NewFile)
+				{
+					UE_LOG(LogCrv, Warning, TEXT("Could not load reference graph %s"), *Files[1]);
+					return;
+				}
+				New = FCrvGraphSnapshot::FromFile(*NewFile);
+			}
+			else
+			{
+				New = FCrvGraphSnapshot::FromGraphs(Subsystem->Cache->GetValidCached(ECrvDirection::Outgoing), Subsystem->Cache->GetValidCached(ECrvDirection::Incoming));
+			}
+			// the cache only holds the current roots, others would all show as removed
+			const bool bOnlySharedRoots = Files.Num() == 1;
+			const auto Diff = FCrvGraphDiff::Compare(FCrvGraphSnapshot::FromFile(*OldFile), New, bOnlySharedRoots);
+			Diff.Log();
+			if (Args.Contains(TEXT("-Highlight")))
+			{
+				Subsystem->ShowGraphDiff(Diff);
+			}
+		})
+	);
+
+	static FAutoConsoleCommandWithWorldAndArgs SpatialIssues(
+		TEXT("ctrl.ReferenceVisualizer.SpatialIssues"),
+		TEXT("Log cached hard references that are too long or cross World Partition cells or data layers, longest first. Args: [MaxCount], defaults to 100"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			const auto Subsystem = GEditor ? GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>() : nullptr;
+			if (!Subsystem) { return; }
+			const int32 MaxCount = Args.Num() ? FCString::Atoi(*Args[0]) : 100;
+			Subsystem->GetSpatialQuery(World).Log(MaxCount);
+		})
+	);
+
+	static FAutoConsoleCommandWithWorldAndArgs DegreeStats(
+		TEXT("ctrl.ReferenceVisualizer.DegreeStats"),
+		TEXT("Log the actors with the most references & a histogram of references per actor. Args: [TopK] [Total|In|Out], defaults to 20 Total"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			const auto Subsystem = GEditor ? GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>() : nullptr;
+			if (!Subsystem || !World) { return; }
+			const int32 TopK = Args.Num() ? FCString::Atoi(*Args[0]) : 20;
+			auto Sort = ECrvDegreeSort::Total;
+			if (Args.Num() > 1)
+			{
+				Sort = Args[1] == TEXT("In") ? ECrvDegreeSort::Incoming : Args[1] == TEXT("Out") ? ECrvDegreeSort::Outgoing : ECrvDegreeSort::Total;
+			}
+			Subsystem->ComputeDegreeStats(World).Log(TopK, Sort);
+		})
+	);
+
+	static FAutoConsoleCommand Cycles(
+		TEXT("ctrl.ReferenceVisualizer.Cycles"),
+		TEXT("Log actors that reference each other in a cycle, from the cached references"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			if (const auto Subsystem = GEditor ? GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>() : nullptr)
+			{
+				Subsystem->CycleIndex.Log();
+			}
+		})
+	);
+
+	static FAutoConsoleCommand ClearDiff(
+		TEXT("ctrl.ReferenceVisualizer.ClearDiff"),
+		TEXT("Stop highlighting graph diff changes"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			if (const auto Subsystem = GEditor ? GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>() : nullptr)
+			{
+				Subsystem->ClearGraphDiff();
+			}
+		})
+	);
+}
+
 void UReferenceVisualizerEditorSubsystem::OnPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
 {
+	// property edits can change bounds e.g. swapping a mesh
+	InvalidateLocation(Object);
+	// or the label
+	NameIndex.Update(Object);
+	// e.g. transforms, materials & floats can't change references
+	if (!Search::CanHoldReferences(PropertyChangedEvent.MemberProperty)) { return; }
 	const FString PropertyChangeDescription = PropertyChangedEvent.GetMemberPropertyName().ToString();
-	if (Cache->WeakRootObjects.Contains(Object))
+	// components & subobjects are searched as part of their owning actor
+	if (Cache->WeakRootObjects.Contains(Object) || Cache->WeakRootObjects.Contains(Object->GetTypedOuter<AActor>()))
 	{
 		Cache->Invalidate(FString::Printf(TEXT("Property modified: %s %s"), *GetDebugName(Object), *PropertyChangeDescription));
 	}
@@ -28,9 +190,42 @@ void UReferenceVisualizerEditorSubsystem::OnPropertyChanged(UObject* Object, FPr
 
 void UReferenceVisualizerEditorSubsystem::OnSettingsModified(UObject* Object, FProperty* Property)
 {
+	LocationCache.Reset();
+	bIsSpatialQueryDirty = true;
+	ActorDescGraph.Reset();
 	UpdateCache();
 }
 
+void UReferenceVisualizerEditorSubsystem::OnComponentTransformChanged(USceneComponent* Component, ETeleportType Teleport)
+{
+	if (Component->IsA<UReferenceVisualizerComponent>()) { return; }
+	InvalidateLocation(Component);
+}
+
+void UReferenceVisualizerEditorSubsystem::InvalidateLocation(const UObject* Object)
+{
+	if (LocationCache.Invalidate(FCrvLocationCache::GetAnchor(Object)))
+	{
+		bIsSpatialQueryDirty = true;
+		OnLocationsChanged.Broadcast();
+	}
+}
+
+void UReferenceVisualizerEditorSubsystem::OnCacheUpdated()
+{
+	bIsSpatialQueryDirty = true;
+	if (GetDefault<UCrvSettings>()->bShowOutgoingReferences)
+	{
+		CycleIndex.Update(Cache->GetValidCached(ECrvDirection::Outgoing));
+	}
+	else
+	{
+		CycleIndex.Reset();
+	}
+	CRV_TRACE_SCOPE("Crv::SyncNameIndex");
+	NameIndex.Sync(Cache->Outgoing, Cache->Incoming);
+}
+
 UReferenceVisualizerEditorSubsystem::UReferenceVisualizerEditorSubsystem()
 {
 	Cache = CreateDefaultSubobject<UCrvRefCache>(TEXT("Cache"));
@@ -46,23 +241,232 @@ void UReferenceVisualizerEditorSubsystem::Initialize(FSubsystemCollectionBase& C
 	SettingsModifiedHandle = Settings->OnModified.AddUObject(this, &UReferenceVisualizerEditorSubsystem::OnSettingsModified);
 	// Settings->AddComponentClass(UReferenceVisualizerComponent::StaticClass());
 	// add visualizer to actors when editor selection is changed
-	USelection::SelectionChangedEvent.AddUObject(this, &UReferenceVisualizerEditorSubsystem::OnSelectionChanged);
-	FCoreUObjectDelegates::OnObjectModified.AddUObject(this, &UReferenceVisualizerEditorSubsystem::OnObjectModified);
+	SelectionTracker.Register();
+	SelectionTracker.OnSelectionDelta.AddUObject(this, &UReferenceVisualizerEditorSubsystem::OnSelectionDelta);
 	FCoreUObjectDelegates::OnObjectPropertyChanged.AddUObject(this, &UReferenceVisualizerEditorSubsystem::OnPropertyChanged);
+	GEngine->OnComponentTransformChanged().AddUObject(this, &UReferenceVisualizerEditorSubsystem::OnComponentTransformChanged);
+	Cache->OnCacheUpdated.AddUObject(this, &UReferenceVisualizerEditorSubsystem::OnCacheUpdated);
+	// descriptors are only updated when actors are saved
+	MapOpenedHandle = FEditorDelegates::OnMapOpened.AddWeakLambda(this, [this](const FString&, bool) { InvalidateActorDescGraph(); });
+	PackageSavedHandle = UPackage::PackageSavedWithContextEvent.AddWeakLambda(this, [this](const FString&, UPackage*, FObjectPostSaveContext) { InvalidateActorDescGraph(); });
+}
+
+const FCrvActorDescGraph& UReferenceVisualizerEditorSubsystem::GetActorDescGraph(UWorld* World)
+{
+	if (!ActorDescGraph.IsBuiltFor(World))
+	{
+		ActorDescGraph.Build(World);
+	}
+	return ActorDescGraph;
+}
+
+void UReferenceVisualizerEditorSubsystem::InvalidateActorDescGraph()
+{
+	ActorDescGraph.Reset();
+}
+
+TArray<FCrvObjectReferences> UReferenceVisualizerEditorSubsystem::FindReferences(const TArray<UObject*>& Objects, const bool bOutgoing, const bool bIncoming)
+{
+	const auto Config = GetDefault<UCrvSettings>();
+	TArray<FCrvObjectReferences> Results;
+	Results.SetNum(Objects.Num());
+	for (int32 Index = 0; Index < Objects.Num(); ++Index)
+	{
+		Results[Index].Object = Objects[Index];
+	}
+	for (const auto Direction : {ECrvDirection::Outgoing, ECrvDirection::Incoming})
+	{
+		const bool bOut = Direction == ECrvDirection::Outgoing;
+		if (!(bOut ? bOutgoing : bIncoming)) { continue; }
+		// the cache only holds directions that are visualized
+		const bool bIsCached = bOut ? Config->bShowOutgoingReferences : Config->bShowIncomingReferences;
+		const auto Cached = bIsCached ? Cache->GetValidCached(Direction) : FCrvObjectGraph();
+		FCrvSet Uncached;
+		for (const auto Object : Objects)
+		{
+			if (IsValid(Object) && !Cached.Contains(Object))
+			{
+				Uncached.Add(Object);
+			}
+		}
+		FCrvObjectGraph Searched;
+		if (Uncached.Num())
+		{
+			if (bOut)
+			{
+				FCrvRefSearch::FindOutRefs(Uncached, Searched);
+			}
+			else
+			{
+				// one referencer scan for all uncached objects
+				FCrvRefSearch::FindInRefsBatched(Uncached, Searched);
+			}
+		}
+		for (int32 Index = 0; Index < Objects.Num(); ++Index)
+		{
+			const auto Object = Objects[Index];
+			if (!IsValid(Object)) { continue; }
+			const auto Found = Cached.Contains(Object) ? Cached.Find(Object) : Searched.Find(Object);
+			if (Found)
+			{
+				(bOut ? Results[Index].Outgoing : Results[Index].Incoming).Append(Found->Array());
+			}
+		}
+	}
+	UE_CLOG(FCrvModule::IsDebugEnabled(), LogCrv, Log, TEXT("FindReferences: %d objects"), Objects.Num());
+	return Results;
+}
+
+void UReferenceVisualizerEditorSubsystem::ShowGraphDiff(const FCrvGraphDiff& Diff)
+{
+	DiffLines.Reset();
+	for (const auto& Change : Diff.Changes)
+	{
+		const auto Root = FSoftObjectPath(Change.RootPath).ResolveObject();
+		const auto Leaf = FSoftObjectPath(Change.LeafPath).ResolveObject();
+		if (!Root || !Leaf) { continue; }
+		DiffLines.FindOrAdd(Root).Add({Leaf, Change.Direction, Change.bAdded});
+	}
+	OnLocationsChanged.Broadcast();
+}
+
+void UReferenceVisualizerEditorSubsystem::ClearGraphDiff()
+{
+	if (DiffLines.IsEmpty()) { return; }
+	DiffLines.Reset();
+	OnLocationsChanged.Broadcast();
+}
+
+const TArray<FCrvDiffLine>* UReferenceVisualizerEditorSubsystem::GetDiffLines(const UObject* RootObject) const
+{
+	return DiffLines.Find(RootObject);
+}
+
+FCrvDegreeStats UReferenceVisualizerEditorSubsystem::ComputeDegreeStats(UWorld* World)
+{
+	TArray<AActor*> Actors;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (IsValid(*It))
+		{
+			Actors.Add(*It);
+		}
+	}
+	// one outgoing search over every actor the cache doesn't have, incoming counts are derived from it
+	auto Outgoing = GetDefault<UCrvSettings>()->bShowOutgoingReferences ? Cache->GetValidCached(ECrvDirection::Outgoing) : FCrvObjectGraph();
+	FCrvSet Uncached;
+	for (const auto Actor : Actors)
+	{
+		if (!Outgoing.Contains(Actor))
+		{
+			Uncached.Add(Actor);
+		}
+	}
+	if (Uncached.Num())
+	{
+		FCrvObjectGraph Searched;
+		FCrvRefSearch::FindOutRefs(Uncached, Searched);
+		Outgoing.Append(MoveTemp(Searched));
+	}
+	return FCrvDegreeStats::Compute(Actors, Outgoing);
+}
+
+void UReferenceVisualizerEditorSubsystem::RegisterComponent(UReferenceVisualizerComponent* Component)
+{
+	if (!Component || !Component->GetWorld()) { return; }
+	ComponentsByWorld.FindOrAdd(Component->GetWorld()).Add(Component);
+}
+
+void UReferenceVisualizerEditorSubsystem::UnregisterComponent(UReferenceVisualizerComponent* Component)
+{
+	// the component may already be leaving its world, there are only a few worlds to check
+	for (auto It = ComponentsByWorld.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().Remove(Component)) { continue; }
+		if (It.Value().IsEmpty())
+		{
+			It.RemoveCurrent();
+		}
+		return;
+	}
+}
+
+FCrvSet UReferenceVisualizerEditorSubsystem::GetRegisteredOwners(const UWorld* World) const
+{
+	FCrvSet Owners;
+	const auto Components = ComponentsByWorld.Find(World);
+	if (!Components) { return Owners; }
+	Owners.Reserve(Components->Num());
+	for (const auto& Key : *Components)
+	{
+		const auto Component = Key.ResolveObjectPtr();
+		if (const auto Owner = Component ? Component->GetOwner() : nullptr)
+		{
+			Owners.Add(Owner);
+		}
+	}
+	return Owners;
 }
 
-void UReferenceVisualizerEditorSubsystem::OnSelectionChanged(UObject* SelectionObject)
+const FCrvSpatialQuery& UReferenceVisualizerEditorSubsystem::GetSpatialQuery(UWorld* World)
+{
+	if (bIsSpatialQueryDirty || SpatialQueryWorld != World)
+	{
+		// every visualizer component reads this while building its lines, build once for all of them
+		bIsSpatialQueryDirty = false;
+		SpatialQueryWorld = World;
+		SpatialQuery.Build(
+			World,
+			Cache->GetValidCached(ECrvDirection::Outgoing),
+			Cache->GetValidCached(ECrvDirection::Incoming),
+			LocationCache,
+			FCrvSpatialQueryParams::FromSettings(GetDefault<UCrvSettings>())
+		);
+	}
+	return SpatialQuery;
+}
+
+void UReferenceVisualizerEditorSubsystem::OnSelectionDelta(const FCrvSet& Added, const FCrvSet& Removed)
 {
 	if (bIsRefreshingSelection)
 	{
 		return;
 	}
 	TGuardValue<bool> ReentrantGuard(bIsRefreshingSelection, true);
+	// locations stay cached, selecting doesn't move anything
+	bIsSpatialQueryDirty = true;
+
+	// roots follow the selection, only search the newly selected objects
+	const auto Mode = GetDefault<UCrvSettings>()->Mode;
+	const int32 NumSelected = SelectionTracker.GetSelection().Num();
+	const int32 NumPreviouslySelected = NumSelected - Added.Num() + Removed.Num();
+	const bool bRootsAreSelection = Mode == ECrvMode::OnlySelected
+		|| (Mode == ECrvMode::SelectedOrAll && NumSelected > 0 && NumPreviouslySelected > 0);
+	if (bRootsAreSelection && Cache->bCached)
+	{
+		Cache->ApplyRootDelta(Added, Removed);
+		return;
+	}
 	UpdateCache();
 }
 
 void UReferenceVisualizerEditorSubsystem::Deinitialize()
 {
+	if (GEngine)
+	{
+		GEngine->OnComponentTransformChanged().RemoveAll(this);
+	}
+	Cache->OnCacheUpdated.RemoveAll(this);
+	SelectionTracker.OnSelectionDelta.RemoveAll(this);
+	SelectionTracker.Unregister();
+	FEditorDelegates::OnMapOpened.Remove(MapOpenedHandle);
+	UPackage::PackageSavedWithContextEvent.Remove(PackageSavedHandle);
+	ActorDescGraph.Reset();
+	LocationCache.Reset();
+	NameIndex.Reset();
+	CycleIndex.Reset();
+	ComponentsByWorld.Reset();
+	SpatialQuery.Reset();
 	Super::Deinitialize();
 }
 
@@ -73,19 +477,54 @@ void UReferenceVisualizerEditorSubsystem::UpdateCache()
 
 FDebugRenderSceneProxy* UReferenceVisualizerComponent::CreateDebugSceneProxy()
 {
+	CRV_TRACE_SCOPE("Crv::CreateDebugSceneProxy");
 	FCtrlReferenceVisualizerSceneProxy* DebugProxy = new FCtrlReferenceVisualizerSceneProxy(this);
-	Lines.Reset();
-	CreateLines(GetOwner(), ECrvDirection::Outgoing);
-	CreateLines(GetOwner(), ECrvDirection::Incoming);
-	DebugProxy->DrawLines(Lines);
-	Lines.Compact();
+	FCrvLines Lines;
+	Lines.BuildPalette(GetDefault<UCrvSettings>());
+	if (GetDefault<UCrvSettings>()->bShowOnlySpatialIssues)
+	{
+		CreateSpatialLines(Lines, GetOwner());
+	}
+	else
+	{
+		CreateLines(Lines, GetOwner(), ECrvDirection::Outgoing);
+		CreateLines(Lines, GetOwner(), ECrvDirection::Incoming);
+		CreateDiffLines(Lines, GetOwner());
+	}
+	Lines.BuildClusters(CtrlRefViz::Picking::ClusterCellSize, CtrlRefViz::Picking::MaxLinesPerCluster);
+	UpdateDebugBounds(Lines);
+	TRACE_COUNTER_INCREMENT(CrvSceneProxies);
+	TRACE_COUNTER_ADD(CrvSceneProxyLines, Lines.Starts.Num());
+	DebugProxy->DrawLines(MoveTemp(Lines));
 	return DebugProxy;
 }
 
+void UReferenceVisualizerComponent::UpdateDebugBounds(const FCrvLines& Lines)
+{
+	const auto Owner = GetOwner();
+	bHasDebugBounds = Owner && CrvEditorSubsystem && GetWorld() && CrvEditorSubsystem->Cache->Contains(Owner);
+	if (!bHasDebugBounds)
+	{
+		LinesBounds.Init();
+		OwnerLocalBounds.Init();
+		return;
+	}
+
+	LinesBounds = Lines.Bounds;
+	// stored relative to this component, so owner moves don't need a new bounds query
+	FVector Origin;
+	FVector BoxExtent;
+	Owner->GetActorBounds(false, Origin, BoxExtent);
+	OwnerLocalBounds = FBox::BuildAABB(Origin, BoxExtent).InverseTransformBy(GetComponentTransform());
+	// render state creation calculated bounds before the lines were built
+	UpdateBounds();
+}
+
 void UReferenceVisualizerComponent::CreateLines(
+	FCrvLines& OutLines,
 	const UObject* RootObject,
 	const ECrvDirection Direction
-)
+) const
 {
 	const auto Config = GetDefault<UCrvSettings>();
 	if (Direction == ECrvDirection::Outgoing && !Config->bShowOutgoingReferences || Direction == ECrvDirection::Incoming && !Config->bShowIncomingReferences)
@@ -93,10 +532,10 @@ void UReferenceVisualizerComponent::CreateLines(
 		return;
 	}
 
-	FVector BaseOffset(0, 0, 10);
 	TObjectPtr<UObject> RootObjectPtr = const_cast<UObject*>(RootObject);
 	auto References = CrvEditorSubsystem->Cache->GetReferences(RootObjectPtr, Direction);
 	if (!CrvEditorSubsystem->Cache->Contains(RootObjectPtr)) { return; }
+	CreateUnloadedLines(OutLines, RootObject, Direction);
 	if (References.Num() == 0) { return; }
 	// when multiple roots are selected, don't show incoming references that are also outgoing to same node
 	if (Direction == ECrvDirection::Incoming && CrvEditorSubsystem->Cache->WeakRootObjects.Num() > 1)
@@ -109,53 +548,277 @@ void UReferenceVisualizerComponent::CreateLines(
 		}));
 		if (References.Num() == 0) { return; }
 	}
-	const FVector SourceLocation = FCtrlReferenceVisualizerSceneProxy::GetObjectLocation(RootObject);
+	auto& LocationCache = CrvEditorSubsystem->LocationCache;
+	const FVector SourceLocation = LocationCache.GetLocation(RootObject);
+	const FVector Offset = CtrlRefViz::Lines::GetLaneOffset(Direction);
+	const auto& CycleIndex = CrvEditorSubsystem->CycleIndex;
+	const bool bHighlightCycles = Config->bHighlightCycles && CycleIndex.NumCycles() > 0;
 	// draw links to referenced objects
-	Lines.Reserve(Lines.Num() + References.Num());
+	OutLines.Reserve(OutLines.Num() + References.Num());
 	UE_CLOG(FCrvModule::IsDebugEnabled(), LogCrv, Log, TEXT("References %s %s"), Direction == ECrvDirection::Outgoing ? TEXT(" Out ") : TEXT(" In "), *CtrlRefViz::GetDebugName(RootObject));
 	for (const auto DstRef : References)
 	{
 		UE_CLOG(FCrvModule::IsDebugEnabled(), LogCrv, Log, TEXT("\t%s"), *CtrlRefViz::GetDebugName(DstRef));
-		auto DstLocation = FCtrlReferenceVisualizerSceneProxy::GetObjectLocation(DstRef);
-		auto Offset = Direction == ECrvDirection::Outgoing ? BaseOffset : -BaseOffset;
-		auto Line = CreateLine(SourceLocation + Offset, DstLocation + Offset, Direction, DstRef->GetClass());
-		Lines.Add(Line);
+		auto DstLocation = LocationCache.GetLocation(DstRef);
+		CreateLine(OutLines, SourceLocation + Offset, DstLocation + Offset, Direction, DstRef);
+		if (bHighlightCycles && CycleIndex.IsInSameCycle(RootObject, DstRef))
+		{
+			OutLines.PaletteIndices.Last() = FCrvLines::GetCyclePaletteIndex(Direction);
+		}
 	}
 }
 
-FCrvLine UReferenceVisualizerComponent::CreateLine(const FVector& SrcOrigin, const FVector& DstOrigin, const ECrvDirection Direction, const UClass* Type)
+void UReferenceVisualizerComponent::CreateUnloadedLines(FCrvLines& OutLines, const UObject* RootObject, const ECrvDirection Direction) const
 {
-	if (Direction == ECrvDirection::Incoming)
+	const auto Actor = Cast<AActor>(RootObject);
+	if (!Actor || !GetDefault<UCrvSettings>()->bShowUnloadedActorReferences) { return; }
+	TArray<const FCrvActorDescNode*> Unloaded;
+	CrvEditorSubsystem->GetActorDescGraph(GetWorld()).GetUnloadedReferences(Actor->GetActorGuid(), Direction, Unloaded);
+	if (!Unloaded.Num()) { return; }
+
+	// same lane as the loaded references of this direction
+	const FVector Offset = CtrlRefViz::Lines::GetLaneOffset(Direction);
+	const FVector SourceLocation = CrvEditorSubsystem->LocationCache.GetLocation(RootObject);
+	OutLines.Reserve(OutLines.Num() + Unloaded.Num());
+	for (const auto Node : Unloaded)
 	{
-		Swap(SrcOrigin, DstOrigin);
+		UE_CLOG(FCrvModule::IsDebugEnabled(), LogCrv, Log, TEXT("\t%s (unloaded)"), *Node->Label.ToString());
+		CreateLine(OutLines, SourceLocation + Offset, Node->Bounds.GetCenter() + Offset, Direction, nullptr);
+		// no leaf object to hover or select, keep the descriptor for the picker
+		OutLines.UnloadedLeaves.Add(OutLines.Num() - 1, {Node->Label, Node->ActorPath, Node->Bounds});
 	}
-	const FVector LineDirection = (DstOrigin - SrcOrigin).GetSafeNormal();
-	const auto Config = GetDefault<UCrvSettings>();
-	float Distance = FVector::Distance(SrcOrigin, DstOrigin) - (Config->Style.CircleRadius * 2);
-	Distance = FMath::Max(1.f, Distance); // clamp distance to be at least 1
-	auto SpacedSrcOrigin = SrcOrigin + LineDirection * Config->Style.CircleRadius;
-	auto SpacedDstOrigin = SpacedSrcOrigin + LineDirection * Distance;
-	auto LineStyle = Config->GetLineStyle(Direction);
-	auto [LineType, LineColor, LineColorComponent, LineColorObject, LineThickness, ArrowSize, DepthPriority] = LineStyle;
-	auto Color = LineColor;
+}
+
+void UReferenceVisualizerComponent::CreateDiffLines(FCrvLines& OutLines, const UObject* RootObject) const
+{
+	const auto Changes = CrvEditorSubsystem ? CrvEditorSubsystem->GetDiffLines(RootObject) : nullptr;
+	if (!Changes) { return; }
+	auto& LocationCache = CrvEditorSubsystem->LocationCache;
+	const FVector SourceLocation = LocationCache.GetLocation(RootObject);
+	for (const auto& [WeakLeaf, Direction, bAdded] : *Changes)
+	{
+		const auto Leaf = WeakLeaf.Get();
+		if (!Leaf) { continue; }
+		// drawn one lane beside the regular lines rather than over them
+		const auto Offset = CtrlRefViz::Lines::GetLaneOffset(Direction, 2);
+		CreateLine(OutLines, SourceLocation + Offset, LocationCache.GetLocation(Leaf) + Offset, Direction, Leaf);
+		// CreateLine picks the palette entry by kind
+		OutLines.PaletteIndices.Last() = FCrvLines::GetDiffPaletteIndex(Direction, bAdded);
+	}
+}
+
+void UReferenceVisualizerComponent::CreateSpatialLines(FCrvLines& OutLines, const UObject* RootObject) const
+{
+	const auto Actor = Cast<AActor>(RootObject);
+	if (!Actor || !CrvEditorSubsystem || !CrvEditorSubsystem->Cache->Contains(Actor)) { return; }
+	TArray<const FCrvSpatialEdge*> Edges;
+	CrvEditorSubsystem->GetSpatialQuery(GetWorld()).GetEdgesOf(Actor, Edges);
+	if (!Edges.Num()) { return; }
+	auto& LocationCache = CrvEditorSubsystem->LocationCache;
+	const FVector SourceLocation = LocationCache.GetLocation(RootObject);
+	for (const auto Edge : Edges)
+	{
+		const bool bIsOutgoing = Edge->Source == Actor;
+		const auto Leaf = bIsOutgoing ? Edge->Target.Get() : Edge->Source.Get();
+		// each edge is drawn once, by its source if that is visualized too
+		if (!Leaf || (!bIsOutgoing && CrvEditorSubsystem->Cache->Contains(Leaf))) { continue; }
+		const auto Direction = bIsOutgoing ? ECrvDirection::Outgoing : ECrvDirection::Incoming;
+		const auto Offset = CtrlRefViz::Lines::GetLaneOffset(Direction);
+		CreateLine(OutLines, SourceLocation + Offset, LocationCache.GetLocation(Leaf) + Offset, Direction, Leaf);
+		OutLines.PaletteIndices.Last() = FCrvLines::GetSpatialPaletteIndex(Direction);
+	}
+}
+
+ECrvObjectKind UReferenceVisualizerComponent::GetObjectKind(const UClass* Type)
+{
+	// classes are resolved once, lines to instances of the same class reuse the result
+	static TMap<TObjectKey<UClass>, ECrvObjectKind> ClassKinds;
+	if (const auto Found = ClassKinds.Find(Type))
+	{
+		return *Found;
+	}
+	auto Kind = ECrvObjectKind::Object;
 	if (Type->IsChildOf(AActor::StaticClass()))
 	{
-		Color = LineColor;
+		Kind = ECrvObjectKind::Actor;
 	}
 	else if (Type->IsChildOf(UActorComponent::StaticClass()))
 	{
-		Color = LineColorComponent;
+		Kind = ECrvObjectKind::Component;
 	}
-	else
+	return ClassKinds.Add(Type, Kind);
+}
+
+void UReferenceVisualizerComponent::CreateLine(
+	FCrvLines& OutLines,
+	const FVector& SrcOrigin,
+	const FVector& DstOrigin,
+	const ECrvDirection Direction,
+	const UObject* Leaf
+) const
+{
+	const bool bIsIncoming = Direction == ECrvDirection::Incoming;
+	const FVector& LineSrc = bIsIncoming ? DstOrigin : SrcOrigin;
+	const FVector& LineDst = bIsIncoming ? SrcOrigin : DstOrigin;
+	const FVector LineDirection = (LineDst - LineSrc).GetSafeNormal();
+	const auto Config = GetDefault<UCrvSettings>();
+	float Distance = FVector::Distance(LineSrc, LineDst) - (Config->Style.CircleRadius * 2);
+	Distance = FMath::Max(1.f, Distance); // clamp distance to be at least 1
+	const auto SpacedSrcOrigin = LineSrc + LineDirection * Config->Style.CircleRadius;
+	const auto SpacedDstOrigin = SpacedSrcOrigin + LineDirection * Distance;
+	// no leaf for actors in unloaded cells
+	const auto Kind = Leaf ? GetObjectKind(Leaf->GetClass()) : ECrvObjectKind::Actor;
+	OutLines.Add(SpacedSrcOrigin, SpacedDstOrigin, FCrvLines::GetPaletteIndex(Direction, Kind), Leaf);
+}
+
+void FCrvLines::BuildPalette(const UCrvSettings* Config)
+{
+	Palette.Reset();
+	Palette.SetNum(GetCyclePaletteIndex(ECrvDirection::Outgoing) + 1);
+	for (const auto Direction : {ECrvDirection::Incoming, ECrvDirection::Outgoing})
+	{
+		const auto LineStyle = Config->GetLineStyle(Direction);
+		auto SetEntry = [&](const ECrvObjectKind Kind, const FLinearColor& Color)
+		{
+			auto& Entry = Palette[GetPaletteIndex(Direction, Kind)];
+			Entry.Color = Color.ToFColor(true);
+			Entry.LineType = LineStyle.LineType;
+			Entry.ArrowSize = LineStyle.ArrowSize;
+		};
+		SetEntry(ECrvObjectKind::Actor, LineStyle.LineColor);
+		SetEntry(ECrvObjectKind::Component, LineStyle.LineColorComponent);
+		SetEntry(ECrvObjectKind::Object, LineStyle.LineColorObject);
+		for (const bool bAdded : {false, true})
+		{
+			auto& Entry = Palette[GetDiffPaletteIndex(Direction, bAdded)];
+			Entry.Color = (bAdded ? Config->Style.DiffAddedColor : Config->Style.DiffRemovedColor).ToFColor(true);
+			Entry.LineType = ECrvLineType::Dash;
+			Entry.ArrowSize = LineStyle.ArrowSize;
+		}
+		auto& SpatialEntry = Palette[GetSpatialPaletteIndex(Direction)];
+		SpatialEntry.Color = Config->Style.SpatialIssueColor.ToFColor(true);
+		SpatialEntry.LineType = ECrvLineType::Arrow;
+		SpatialEntry.ArrowSize = LineStyle.ArrowSize;
+		// keeps the direction's line type, only the color marks the cycle
+		auto& CycleEntry = Palette[GetCyclePaletteIndex(Direction)];
+		CycleEntry.Color = Config->Style.CycleColor.ToFColor(true);
+		CycleEntry.LineType = LineStyle.LineType;
+		CycleEntry.ArrowSize = LineStyle.ArrowSize;
+	}
+}
+
+void FCrvLines::Add(const FVector& Start, const FVector& End, const uint8 PaletteIndex, const UObject* Leaf)
+{
+	Starts.Add(FVector3f(Start));
+	Ends.Add(FVector3f(End));
+	PaletteIndices.Add(PaletteIndex);
+	Leaves.Add(Leaf);
+	Bounds += Start;
+	Bounds += End;
+}
+
+void FCrvLines::BuildClusters(const double CellSize, const int32 MaxLinesPerCluster)
+{
+	ClusteredLines.Reset(Num());
+	Clusters.Reset();
+	TMap<FIntVector, TArray<int32>> Cells;
+	for (int32 Index = 0; Index < Num(); ++Index)
 	{
-		Color = LineColorObject;
+		const FVector Mid = FVector(Starts[Index] + Ends[Index]) * 0.5;
+		const FIntVector Cell(
+			FMath::FloorToInt32(Mid.X / CellSize),
+			FMath::FloorToInt32(Mid.Y / CellSize),
+			FMath::FloorToInt32(Mid.Z / CellSize)
+		);
+		Cells.FindOrAdd(Cell).Add(Index);
+	}
+
+	for (const auto& [Cell, Indices] : Cells)
+	{
+		for (int32 First = 0; First < Indices.Num(); First += MaxLinesPerCluster)
+		{
+			FCrvLineCluster Cluster;
+			Cluster.First = ClusteredLines.Num();
+			Cluster.Num = FMath::Min(MaxLinesPerCluster, Indices.Num() - First);
+			ClusteredLines.Append(&Indices[First], Cluster.Num);
+			Clusters.Add(Cluster);
+		}
 	}
-	FCrvLine Line;
-	Line.Start = SpacedSrcOrigin;
-	Line.End = SpacedDstOrigin;
-	Line.Style = LineStyle;
-	Line.Color = Color.ToFColor(true);
-	return Line;
+}
+
+int32 FCrvLines::FindNearestLine(const FCrvLineCluster& Cluster, const FVector& RayOrigin, const FVector& RayDirection, FVector& OutClosestPoint) const
+{
+	const FVector RayEnd = RayOrigin + RayDirection * HALF_WORLD_MAX;
+	int32 NearestIndex = INDEX_NONE;
+	double NearestAngle = TNumericLimits<double>::Max();
+	for (int32 Index = Cluster.First; Index < Cluster.First + Cluster.Num; ++Index)
+	{
+		const int32 LineIndex = ClusteredLines[Index];
+		FVector OnRay;
+		FVector OnLine;
+		FMath::SegmentDistToSegmentSafe(RayOrigin, RayEnd, FVector(Starts[LineIndex]), FVector(Ends[LineIndex]), OnRay, OnLine);
+		// distance relative to depth, so near & far lines compare as they appear on screen
+		const double Angle = FVector::Distance(OnRay, OnLine) / FMath::Max(1.0, FVector::Distance(RayOrigin, OnRay));
+		if (Angle < NearestAngle)
+		{
+			NearestAngle = Angle;
+			NearestIndex = LineIndex;
+			OutClosestPoint = OnLine;
+		}
+	}
+	return NearestIndex;
+}
+
+void FCrvLines::Reserve(const int32 Number)
+{
+	Starts.Reserve(Number);
+	Ends.Reserve(Number);
+	PaletteIndices.Reserve(Number);
+	Leaves.Reserve(Number);
+}
+
+void FCrvLines::Reset()
+{
+	Starts.Reset();
+	Ends.Reset();
+	PaletteIndices.Reset();
+	Leaves.Reset();
+	UnloadedLeaves.Reset();
+	ClusteredLines.Reset();
+	Clusters.Reset();
+	Bounds = FBox(ForceInit);
+}
+
+SIZE_T FCrvLines::GetAllocatedSize() const
+{
+	return Starts.GetAllocatedSize()
+		+ Ends.GetAllocatedSize()
+		+ PaletteIndices.GetAllocatedSize()
+		+ Leaves.GetAllocatedSize()
+		+ UnloadedLeaves.GetAllocatedSize()
+		+ Palette.GetAllocatedSize()
+		+ ClusteredLines.GetAllocatedSize()
+		+ Clusters.GetAllocatedSize();
+}
+
+static void DrawArrowLine(FPrimitiveDrawInterface* PDI, const FVector& Start, const FVector& End, const FColor& Color, const ESceneDepthPriorityGroup DepthPriorityGroup)
+{
+	// draw a pretty arrow
+	FVector Dir = End - Start;
+	const float DirMag = Dir.Size();
+	Dir /= DirMag;
+	FVector YAxis, ZAxis;
+	Dir.FindBestAxisVectors(YAxis, ZAxis);
+	FMatrix ArrowTM(Dir, YAxis, ZAxis, Start);
+	DrawDirectionalArrow(
+		PDI,
+		ArrowTM,
+		Color,
+		DirMag,
+		8.f,
+		DepthPriorityGroup,
+		1.f
+	);
 }
 
 void FCtrlReferenceVisualizerSceneProxy::GetDynamicMeshElementsForView(
@@ -168,6 +831,8 @@ void FCtrlReferenceVisualizerSceneProxy::GetDynamicMeshElementsForView(
 	FMaterialCache& SolidMeshMaterialCache
 ) const
 {
+	CRV_TRACE_SCOPE("Crv::GetDynamicMeshElementsForView");
+	TRACE_COUNTER_SET(CrvDrawnPass, PassId);
 	FPrimitiveDrawInterface* PDI = Collector.GetPDI(ViewIndex);
 
 	// Draw Lines
@@ -189,22 +854,44 @@ void FCtrlReferenceVisualizerSceneProxy::GetDynamicMeshElementsForView(
 	PDI->AddReserveLines(DepthPriorityGroup, 5 * ArrowsNum, false, false);
 	for (const FArrowLine& ArrowLine : ArrowLines)
 	{
-		// draw a pretty arrow
-		FVector Dir = ArrowLine.End - ArrowLine.Start;
-		const float DirMag = Dir.Size();
-		Dir /= DirMag;
-		FVector YAxis, ZAxis;
-		Dir.FindBestAxisVectors(YAxis, ZAxis);
-		FMatrix ArrowTM(Dir, YAxis, ZAxis, ArrowLine.Start);
-		DrawDirectionalArrow(
-			PDI,
-			ArrowTM,
-			ArrowLine.Color,
-			DirMag,
-			8.f,
-			DepthPriorityGroup,
-			1.f
-		);
+		DrawArrowLine(PDI, ArrowLine.Start, ArrowLine.End, ArrowLine.Color, DepthPriorityGroup);
+	}
+
+	// Draw Reference Lines, by cluster so each cluster is drawn with its hit proxy
+	if (CrvLines.IsValid())
+	{
+		const FCrvLines& RefLines = *CrvLines;
+		const bool bHitTesting = PDI->IsHitTesting();
+		PDI->AddReserveLines(DepthPriorityGroup, 5 * RefLines.Num(), false, false);
+		for (int32 ClusterIndex = 0; ClusterIndex < RefLines.Clusters.Num(); ++ClusterIndex)
+		{
+			PDI->SetHitProxy(ClusterHitProxies.IsValidIndex(ClusterIndex) ? ClusterHitProxies[ClusterIndex] : nullptr);
+			const auto& Cluster = RefLines.Clusters[ClusterIndex];
+			for (int32 ClusteredIndex = Cluster.First; ClusteredIndex < Cluster.First + Cluster.Num; ++ClusteredIndex)
+			{
+				const int32 Index = RefLines.ClusteredLines[ClusteredIndex];
+				const auto& [Color, LineType, ArrowSize] = RefLines.Palette[RefLines.PaletteIndices[Index]];
+				const FVector Start(RefLines.Starts[Index]);
+				const FVector End(RefLines.Ends[Index]);
+				if (bHitTesting)
+				{
+					PDI->DrawLine(Start, End, Color, DepthPriorityGroup, CtrlRefViz::Picking::HitProxyLineThickness, 0, true);
+				}
+				else if (LineType == ECrvLineType::Dash)
+				{
+					const auto Direction = (End - Start).GetSafeNormal();
+					const auto Distance = FVector::Distance(Start, End);
+					DrawDashedLine(PDI, Start, End, Color, Distance / 20, DepthPriorityGroup);
+					const auto ArrowStart = Start + Direction * (Distance - ArrowSize * UE_GOLDEN_RATIO * 2);
+					DrawArrowLine(PDI, ArrowStart, End, Color, DepthPriorityGroup);
+				}
+				else if (LineType == ECrvLineType::Arrow)
+				{
+					DrawArrowLine(PDI, Start, End, Color, DepthPriorityGroup);
+				}
+			}
+		}
+		PDI->SetHitProxy(nullptr);
 	}
 
 	// Draw Stars
@@ -250,45 +937,53 @@ void FCtrlReferenceVisualizerSceneProxy::GetDynamicMeshElementsForView(
 		}
 	}
 
-	// Draw Meshes
+	// Draw Meshes, batched into one mesh per colour
+	TArray<FColor, TInlineAllocator<8>> MeshColors;
 	for (const FMesh& Mesh : Meshes)
+	{
+		MeshColors.AddUnique(Mesh.Color);
+	}
+	FDynamicMeshBuilderSettings Settings;
+	Settings.bWireframe = true;
+	Settings.bUseSelectionOutline = false;
+	Settings.bUseWireframeSelectionColoring = true;
+	for (const FColor& Color : MeshColors)
 	{
 		FDynamicMeshBuilder MeshBuilder(View->GetFeatureLevel());
-		MeshBuilder.AddVertices(Mesh.Vertices);
-		MeshBuilder.AddTriangles(Mesh.Indices);
-
-		// auto&& MeshMaterialCache = Mesh.Color.A == 255 ? SolidMeshMaterialCache : DefaultMaterialCache; 
-		// MeshBuilder.GetMesh(FMatrix::Identity, MeshMaterialCache[Mesh.Color], SDPG_World, false, false, ViewIndex, Collector);
-		// Parent caches these (only within this function) but let's assume that's not worth it. Will people really
-		// have lots of meshes with a shared colour in this single context to make it worth it?
-		const auto MatRenderProxy = new FColoredMaterialRenderProxy(GEngine->WireframeMaterial->GetRenderProxy(), Mesh.Color);
-		FDynamicMeshBuilderSettings Settings;
-		Settings.bWireframe = true;
-		Settings.bUseSelectionOutline = false;
-		Settings.bUseWireframeSelectionColoring = true;
-		MeshBuilder.GetMesh(FMatrix::Identity, MatRenderProxy, DepthPriorityGroup, Settings, nullptr, ViewIndex, Collector);
+		for (const FMesh& Mesh : Meshes)
+		{
+			if (Mesh.Color != Color) { continue; }
+			const int32 BaseIndex = MeshBuilder.AddVertices(Mesh.Vertices);
+			for (int32 Index = 0; Index + 2 < Mesh.Indices.Num(); Index += 3)
+			{
+				MeshBuilder.AddTriangle(
+					BaseIndex + Mesh.Indices[Index],
+					BaseIndex + Mesh.Indices[Index + 1],
+					BaseIndex + Mesh.Indices[Index + 2]
+				);
+			}
+		}
+		MeshBuilder.GetMesh(FMatrix::Identity, GetMeshMaterial(Color), DepthPriorityGroup, Settings, nullptr, ViewIndex, Collector);
 	}
 }
 
-void FCtrlReferenceVisualizerSceneProxy::DrawLines(TSet<FCrvLine> InLines)
+void FCtrlReferenceVisualizerSceneProxy::DrawLines(FCrvLines&& InLines)
 {
-	for (auto Line : InLines)
-	{
-		auto [LineType, LineColor, LineColorComponent, LineColorObject, LineThickness, ArrowSize, DepthPriority] = Line.Style;
-		auto Direction = (Line.End - Line.Start).GetSafeNormal();
-		auto Distance = FVector::Distance(Line.Start, Line.End);
+	CrvLines = MakeShared<const FCrvLines>(MoveTemp(InLines));
+}
 
-		if (LineType == ECrvLineType::Dash)
-		{
-			DashedLines.Add(FDebugRenderSceneProxy::FDashedLine(Line.Start, Line.End, Line.Color.ToFColor(true), Distance / 20));
-			auto ArrowStart = Line.Start + Direction * (Distance - ArrowSize * UE_GOLDEN_RATIO * 2);
-			ArrowLines.Add(FDebugRenderSceneProxy::FArrowLine(ArrowStart, Line.End, Line.Color.ToFColor(true)));
-		}
-		else if (LineType == ECrvLineType::Arrow)
-		{
-			ArrowLines.Add(FDebugRenderSceneProxy::FArrowLine(Line.Start, Line.End, Line.Color.ToFColor(true)));
-		}
+HHitProxy* FCtrlReferenceVisualizerSceneProxy::CreateHitProxies(UPrimitiveComponent* Component, TArray<TRefCountPtr<HHitProxy>>& OutHitProxies)
+{
+	const auto DefaultHitProxy = FDebugRenderSceneProxy::CreateHitProxies(Component, OutHitProxies);
+	if (!CrvLines.IsValid()) { return DefaultHitProxy; }
+	ClusterHitProxies.Reset(CrvLines->Clusters.Num());
+	for (int32 ClusterIndex = 0; ClusterIndex < CrvLines->Clusters.Num(); ++ClusterIndex)
+	{
+		HHitProxy* HitProxy = new HCrvLineClusterHitProxy(Component, Component->GetOwner(), CrvLines, ClusterIndex);
+		OutHitProxies.Add(HitProxy);
+		ClusterHitProxies.Add(HitProxy);
 	}
+	return DefaultHitProxy;
 }
 
 FVector FCtrlReferenceVisualizerSceneProxy::GetComponentLocation(const UActorComponent* Component)
@@ -329,7 +1024,23 @@ FVector FCtrlReferenceVisualizerSceneProxy::GetActorOrigin(const AActor* Actor)
 	return Actor->GetActorLocation();
 }
 
-FCtrlReferenceVisualizerSceneProxy::FCtrlReferenceVisualizerSceneProxy(const UPrimitiveComponent* InComponent): FDebugRenderSceneProxy(InComponent) {}
+FCtrlReferenceVisualizerSceneProxy::FCtrlReferenceVisualizerSceneProxy(const UPrimitiveComponent* InComponent)
+	: FDebugRenderSceneProxy(InComponent),
+	  PassId(CtrlRefViz::Trace::GetPassId()) {}
+
+// out of line so MeshMaterials can hold an incomplete type in the header
+FCtrlReferenceVisualizerSceneProxy::~FCtrlReferenceVisualizerSceneProxy() = default;
+
+const FColoredMaterialRenderProxy* FCtrlReferenceVisualizerSceneProxy::GetMeshMaterial(const FColor& Color) const
+{
+	// views can be gathered in parallel
+	FScopeLock Lock(&MeshMaterialsLock);
+	if (const auto Found = MeshMaterials.Find(Color))
+	{
+		return Found->Get();
+	}
+	return MeshMaterials.Add(Color, MakeUnique<FColoredMaterialRenderProxy>(GEngine->WireframeMaterial->GetRenderProxy(), Color)).Get();
+}
 
 SIZE_T FCtrlReferenceVisualizerSceneProxy::GetTypeHash() const
 {
@@ -351,7 +1062,7 @@ FPrimitiveViewRelevance FCtrlReferenceVisualizerSceneProxy::GetViewRelevance(con
 
 uint32 FCtrlReferenceVisualizerSceneProxy::GetMemoryFootprint() const
 {
-	return sizeof(*this) + GetAllocatedSize();
+	return sizeof(*this) + GetAllocatedSize() + (CrvLines.IsValid() ? CrvLines->GetAllocatedSize() : 0) + ClusterHitProxies.GetAllocatedSize() + MeshMaterials.GetAllocatedSize();
 }
 
 FVector FCtrlReferenceVisualizerSceneProxy::GetObjectLocation(const UObject* Object)
@@ -379,29 +1090,18 @@ FVector FCtrlReferenceVisualizerSceneProxy::GetObjectLocation(const UObject* Obj
 FBoxSphereBounds UReferenceVisualizerComponent::CalcBounds(const FTransform& LocalToWorld) const
 {
 	auto SphereBounds = Super::CalcBounds(LocalToWorld);
-	if (!GetOwner()) { return SphereBounds; }
-	if (!CrvEditorSubsystem)
-	{
-		return SphereBounds;
-	}
-	const auto World = GetWorld();
-	if (!World) { return SphereBounds; }
-	if (!CrvEditorSubsystem->Cache->Contains(GetOwner()))
-	{
-		return SphereBounds;
-	}
+	// accumulated in UpdateDebugBounds when lines are built
+	if (!bHasDebugBounds) { return SphereBounds; }
 
 	FBoxSphereBounds::Builder DebugBoundsBuilder;
 	DebugBoundsBuilder += SphereBounds;
-	FVector Origin;
-	FVector BoxExtent;
-	GetOwner()->GetActorBounds(false, Origin, BoxExtent);
-	FBox ActorBounds = FBox::BuildAABB(Origin, BoxExtent);
-	DebugBoundsBuilder += ActorBounds;
-	for (auto [Start, End, Color, Style] : Lines)
+	if (OwnerLocalBounds.IsValid)
+	{
+		DebugBoundsBuilder += OwnerLocalBounds.TransformBy(LocalToWorld);
+	}
+	if (LinesBounds.IsValid)
 	{
-		DebugBoundsBuilder += Start;
-		DebugBoundsBuilder += End;
+		DebugBoundsBuilder += LinesBounds;
 	}
 	FBoxSphereBounds NewBounds = DebugBoundsBuilder; //.TransformBy(LocalToWorld);
 	NewBounds = NewBounds.ExpandBy(100);
@@ -412,7 +1112,9 @@ void UReferenceVisualizerComponent::OnRegister()
 {
 	Super::OnRegister();
 	CrvEditorSubsystem = GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>();
+	CrvEditorSubsystem->RegisterComponent(this);
 	CrvEditorSubsystem->Cache->OnCacheUpdated.AddUObject(this, &UReferenceVisualizerComponent::MarkRenderStateDirty);
+	CrvEditorSubsystem->OnLocationsChanged.AddUObject(this, &UReferenceVisualizerComponent::MarkRenderStateDirty);
 	CrvEditorSubsystem->Cache->ScheduleUpdate();
 }
 
@@ -421,6 +1123,8 @@ void UReferenceVisualizerComponent::OnUnregister()
 	Super::OnUnregister();
 	if (CrvEditorSubsystem)
 	{
+		CrvEditorSubsystem->UnregisterComponent(this);
+		CrvEditorSubsystem->OnLocationsChanged.RemoveAll(this);
 		CrvEditorSubsystem->Cache->ScheduleUpdate();
 	}
 }
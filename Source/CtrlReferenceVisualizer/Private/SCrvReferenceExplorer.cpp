@@ -0,0 +1,480 @@
+#include "SCrvReferenceExplorer.h"
+
+#include "CrvRefCache.h"
+#include "CrvRefSearch.h"
+#include "CrvTrace.h"
+#include "CtrlReferenceVisualizer.h"
+#include "ReferenceVisualizerComponent.h"
+
+#include "Styling/StyleColors.h"
+
+#include "Widgets/Images/SImage.h"
+#include "Widgets/Input/SCheckBox.h"
+#include "Widgets/Input/SSearchBox.h"
+#include "Widgets/Input/SSegmentedControl.h"
+#include "Widgets/Layout/SBorder.h"
+#include "Widgets/Text/STextBlock.h"
+
+#define LOCTEXT_NAMESPACE "ReferenceVisualizer"
+
+namespace CtrlRefViz::Explorer
+{
+	// time per tick spent searching & adding rows
+	constexpr double PopulateBudgetSeconds = 0.004;
+	constexpr int32 MaxSearchResults = 1000;
+	// objects searched per frame, expanded rows first
+	constexpr int32 MaxSearchBatch = 256;
+}
+
+void SCrvReferenceExplorer::Construct(const FArguments& InArgs)
+{
+	if (const auto Subsystem = GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>())
+	{
+		SelectionDeltaHandle = Subsystem->SelectionTracker.OnSelectionDelta.AddSP(this, &SCrvReferenceExplorer::OnSelectionDelta);
+		CacheUpdatedHandle = Subsystem->Cache->OnCacheUpdated.AddSP(this, &SCrvReferenceExplorer::RequestRefresh);
+	}
+
+	ChildSlot
+	[
+		SNew(SBorder)
+		.BorderImage(FAppStyle::GetBrush("ToolPanel.GroupBorder"))
+		.Padding(FMargin(4.0f))
+		[
+			SNew(SVerticalBox)
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			.Padding(0.0f, 0.0f, 0.0f, 4.0f)
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				[
+					SNew(SSegmentedControl<ECrvDirection>)
+					.Value(this, &SCrvReferenceExplorer::GetDirection)
+					.OnValueChanged(this, &SCrvReferenceExplorer::SetDirection)
+					+ SSegmentedControl<ECrvDirection>::Slot(ECrvDirection::Outgoing)
+					.Text(LOCTEXT("OutgoingReferences", "Outgoing"))
+					+ SSegmentedControl<ECrvDirection>::Slot(ECrvDirection::Incoming)
+					.Text(LOCTEXT("IncomingReferences", "Incoming"))
+				]
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.VAlign(VAlign_Center)
+				.Padding(FMargin(4.0f, 0.0f, 0.0f, 0.0f))
+				[
+					SNew(SCheckBox)
+					.IsChecked(this, &SCrvReferenceExplorer::GetShowCycles)
+					.OnCheckStateChanged(this, &SCrvReferenceExplorer::SetShowCycles)
+					.ToolTipText(LOCTEXT("ShowCyclesToolTip", "Show actors that reference each other in a cycle instead of the selection"))
+					[
+						SNew(STextBlock)
+						.Text(LOCTEXT("ShowCycles", "Cycles"))
+					]
+				]
+				+ SHorizontalBox::Slot()
+				.FillWidth(1.0f)
+				.Padding(FMargin(4.0f, 0.0f))
+				[
+					SNew(SSearchBox)
+					.HintText(LOCTEXT("ExplorerSearchHint", "Select by name e.g. BP_Door*"))
+					.OnTextCommitted(this, &SCrvReferenceExplorer::OnSearchCommitted)
+				]
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.VAlign(VAlign_Center)
+				[
+					SNew(STextBlock)
+					.Text(this, &SCrvReferenceExplorer::GetStatusText)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.FillHeight(1.0f)
+			[
+				SAssignNew(TreeView, STreeView<FCrvExplorerItemPtr>)
+				.TreeItemsSource(&RootItems)
+				.SelectionMode(ESelectionMode::Single)
+				.OnGenerateRow(this, &SCrvReferenceExplorer::OnGenerateRow)
+				.OnGetChildren(this, &SCrvReferenceExplorer::OnGetChildren)
+				.OnExpansionChanged(this, &SCrvReferenceExplorer::OnExpansionChanged)
+				.OnMouseButtonDoubleClick(this, &SCrvReferenceExplorer::OnDoubleClick)
+			]
+		]
+	];
+}
+
+SCrvReferenceExplorer::~SCrvReferenceExplorer()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(SearchTickerHandle);
+	if (GEditor)
+	{
+		if (const auto Subsystem = GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>())
+		{
+			Subsystem->SelectionTracker.OnSelectionDelta.Remove(SelectionDeltaHandle);
+			Subsystem->Cache->OnCacheUpdated.Remove(CacheUpdatedHandle);
+		}
+	}
+}
+
+void SCrvReferenceExplorer::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
+{
+	SCompoundWidget::Tick(AllottedGeometry, InCurrentTime, InDeltaTime);
+	if (bRefreshRequested)
+	{
+		Refresh();
+	}
+	if (Pending.IsEmpty()) { return; }
+	if (PopulatePending(FPlatformTime::Seconds() + Explorer::PopulateBudgetSeconds))
+	{
+		TreeView->RequestTreeRefresh();
+	}
+}
+
+void SCrvReferenceExplorer::RequestRefresh()
+{
+	bRefreshRequested = true;
+}
+
+void SCrvReferenceExplorer::Refresh()
+{
+	bRefreshRequested = false;
+	TSet<FCrvExplorerItemPtr> ExpandedItems;
+	TreeView->GetExpandedItems(ExpandedItems);
+	ExpansionToRestore.Reset();
+	for (const auto& Item : ExpandedItems)
+	{
+		if (Item.IsValid() && Item->Object.IsValid())
+		{
+			ExpansionToRestore.Add(Item->Object.Get());
+		}
+	}
+	Pending.Reset();
+	SearchedRefs.Reset();
+	ToSearch.Reset();
+	RootItems.Reset();
+	NumRows = 0;
+	if (bShowCycles)
+	{
+		AddCycleItems();
+		TreeView->RequestTreeRefresh();
+		return;
+	}
+	for (const auto Object : FCrvRefSearch::GetSelectionSet())
+	{
+		if (!Object) { continue; }
+		const auto Item = MakeShared<FCrvExplorerItem>(Object);
+		RootItems.Add(Item);
+		ExpansionToRestore.Remove(Object);
+		RequestChildren(Item);
+		TreeView->SetItemExpansion(Item, true);
+	}
+	NumRows = RootItems.Num();
+	TreeView->RequestTreeRefresh();
+}
+
+void SCrvReferenceExplorer::AddCycleItems()
+{
+	const auto Subsystem = GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>();
+	if (!Subsystem) { return; }
+	for (const auto& Cycle : Subsystem->CycleIndex.GetCycles())
+	{
+		const auto Item = MakeShared<FCrvExplorerItem>();
+		Item->GroupLabel = FText::Format(LOCTEXT("ExplorerCycle", "Cycle of {0} actors"), FText::AsNumber(Cycle.Num()));
+		// members are known, their own references are found when expanded
+		Item->bChildrenRequested = true;
+		for (const auto Actor : Cycle)
+		{
+			Item->Children.Add(MakeShared<FCrvExplorerItem>(Actor));
+		}
+		RootItems.Add(Item);
+		TreeView->SetItemExpansion(Item, true);
+		for (const auto& Child : Item->Children)
+		{
+			RestoreExpansion(Child);
+		}
+		NumRows += 1 + Item->Children.Num();
+	}
+}
+
+void SCrvReferenceExplorer::RequestChildren(const FCrvExplorerItemPtr& Item)
+{
+	if (!Item.IsValid() || Item->IsPlaceholder() || Item->bChildrenRequested) { return; }
+	Item->bChildrenRequested = true;
+	// placeholder row until the first children are added
+	Item->Children = {MakeShared<FCrvExplorerItem>()};
+	Pending.Add({Item});
+}
+
+void SCrvReferenceExplorer::RestoreExpansion(const FCrvExplorerItemPtr& Item)
+{
+	if (!Item->Object.IsValid() || !ExpansionToRestore.Remove(Item->Object.Get())) { return; }
+	RequestChildren(Item);
+	TreeView->SetItemExpansion(Item, true);
+}
+
+bool SCrvReferenceExplorer::PopulatePending(const double EndTime)
+{
+	bool bChanged = false;
+	int32 Index = 0;
+	while (Index < Pending.Num() && FPlatformTime::Seconds() < EndTime)
+	{
+		auto& Current = Pending[Index];
+		const auto Item = Current.Item.Pin();
+		if (!Item.IsValid() || !Item->Object.IsValid())
+		{
+			Pending.RemoveAt(Index);
+			continue;
+		}
+		if (!Current.bResolved)
+		{
+			const auto Known = FindKnownReferences(Item->Object.Get());
+			if (!Known)
+			{
+				// keeps its placeholder row until searched
+				ScheduleSearch();
+				++Index;
+				continue;
+			}
+			Current.Refs = Known->Array();
+			Current.bResolved = true;
+			Item->Children.Reset(Current.Refs.Num());
+			bChanged = true;
+		}
+		// add rows in batches, checking the budget between them
+		constexpr int32 BatchSize = 256;
+		const int32 Start = Item->Children.Num();
+		const int32 End = FMath::Min(Current.Next + BatchSize, Current.Refs.Num());
+		for (; Current.Next < End; ++Current.Next)
+		{
+			if (const auto Ref = Current.Refs[Current.Next].Get())
+			{
+				Item->Children.Add(MakeShared<FCrvExplorerItem>(Ref));
+				++NumRows;
+			}
+		}
+		bChanged = true;
+		if (Current.Next >= Current.Refs.Num())
+		{
+			Pending.RemoveAt(Index);
+		}
+		// after the last use of Current, restoring adds to Pending
+		for (int32 Child = Start; Child < Item->Children.Num(); ++Child)
+		{
+			RestoreExpansion(Item->Children[Child]);
+		}
+	}
+	return bChanged;
+}
+
+const FCrvWeakSet* SCrvReferenceExplorer::FindKnownReferences(UObject* Object) const
+{
+	if (const auto Subsystem = GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>())
+	{
+		const auto Cache = Subsystem->Cache;
+		const auto& Cached = Direction == ECrvDirection::Outgoing ? Cache->Outgoing : Cache->Incoming;
+		if (const auto Found = Cached.Find(Object))
+		{
+			return Found;
+		}
+	}
+	return SearchedRefs.Find(Object);
+}
+
+void SCrvReferenceExplorer::ScheduleSearch()
+{
+	if (SearchTickerHandle.IsValid()) { return; }
+	// on the next frame, so placeholder rows are drawn before searching
+	SearchTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &SCrvReferenceExplorer::SearchPending));
+}
+
+bool SCrvReferenceExplorer::SearchPending(const float DeltaTime)
+{
+	CRV_TRACE_SCOPE("Crv::ExplorerSearch");
+	SearchTickerHandle.Reset();
+	FCrvSet Roots;
+	for (const auto& Current : Pending)
+	{
+		const auto Item = Current.Item.Pin();
+		const auto Object = Item.IsValid() ? Item->Object.Get() : nullptr;
+		if (!Current.bResolved && Object && !FindKnownReferences(Object))
+		{
+			Roots.Add(Object);
+		}
+	}
+	for (const auto& WeakObject : ToSearch)
+	{
+		if (Roots.Num() >= Explorer::MaxSearchBatch) { break; }
+		const auto Object = WeakObject.Get();
+		if (Object && !FindKnownReferences(Object))
+		{
+			Roots.Add(Object);
+		}
+	}
+	// rows left over are queued again when the tree asks for their children
+	ToSearch.Reset();
+	if (Roots.IsEmpty()) { return false; }
+
+	// one search for the whole batch
+	FCrvObjectGraph Graph;
+	if (Direction == ECrvDirection::Outgoing)
+	{
+		FCrvRefSearch::FindOutRefs(Roots, Graph);
+	}
+	else
+	{
+		FCrvRefSearch::FindInRefsBatched(Roots, Graph);
+	}
+	for (const auto Root : Roots)
+	{
+		const auto Found = Graph.Find(Root);
+		SearchedRefs.Add(Root, Found ? ToWeakSet(*Found) : FCrvWeakSet());
+	}
+	UE_CLOG(FCrvModule::IsDebugEnabled(), LogCrv, Log, TEXT("Explorer searched %d objects"), Roots.Num());
+	TreeView->RequestTreeRefresh();
+	return false;
+}
+
+TSharedRef<ITableRow> SCrvReferenceExplorer::OnGenerateRow(FCrvExplorerItemPtr Item, const TSharedRef<STableViewBase>& OwnerTable) const
+{
+	if (Item->IsGroup())
+	{
+		return SNew(STableRow<FCrvExplorerItemPtr>, OwnerTable)
+		[
+			SNew(STextBlock)
+			.Text(Item->GroupLabel)
+			.ColorAndOpacity(FStyleColors::Warning)
+		];
+	}
+	if (Item->IsPlaceholder() || !Item->Object.IsValid())
+	{
+		return SNew(STableRow<FCrvExplorerItemPtr>, OwnerTable)
+		[
+			SNew(STextBlock)
+			.Text(Item->IsPlaceholder() ? LOCTEXT("ExplorerLoading", "Loading...") : LOCTEXT("ExplorerInvalid", "(invalid)"))
+			.ColorAndOpacity(FSlateColor::UseSubduedForeground())
+		];
+	}
+
+	// only visible rows are generated, so labels & icons are resolved on demand
+	const auto Entry = FCrvRefSearch::MakeMenuEntry(nullptr, Item->Object.Get());
+	const auto Subsystem = GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>();
+	const bool bIsInCycle = Subsystem && Subsystem->CycleIndex.IsInCycle(Item->Object.Get());
+	return SNew(STableRow<FCrvExplorerItemPtr>, OwnerTable)
+		.ToolTipText(Entry.ToolTip)
+		[
+			SNew(SHorizontalBox)
+			+ SHorizontalBox::Slot()
+			.AutoWidth()
+			.VAlign(VAlign_Center)
+			.Padding(FMargin(0.0f, 0.0f, 4.0f, 0.0f))
+			[
+				SNew(SImage)
+				.Image(Entry.Icon.GetIcon())
+			]
+			+ SHorizontalBox::Slot()
+			.FillWidth(1.0f)
+			.VAlign(VAlign_Center)
+			[
+				SNew(STextBlock)
+				.Text(Entry.Label)
+				.ColorAndOpacity(bIsInCycle ? FStyleColors::Warning : FSlateColor::UseForeground())
+			]
+		];
+}
+
+void SCrvReferenceExplorer::OnGetChildren(FCrvExplorerItemPtr Item, TArray<FCrvExplorerItemPtr>& OutChildren)
+{
+	if (!Item.IsValid() || Item->IsPlaceholder()) { return; }
+	if (!Item->bChildrenRequested)
+	{
+		// expander only for objects with references, or not searched yet
+		const auto Object = Item->Object.Get();
+		const auto Known = Object ? FindKnownReferences(Object) : nullptr;
+		if (Object && !Known)
+		{
+			ToSearch.Add(Object);
+			ScheduleSearch();
+		}
+		const bool bMayHaveChildren = Object && (!Known || Known->Num() > 0);
+		if (!bMayHaveChildren)
+		{
+			Item->Children.Reset();
+		}
+		else if (!Item->Children.Num())
+		{
+			Item->Children = {MakeShared<FCrvExplorerItem>()};
+		}
+	}
+	OutChildren = Item->Children;
+}
+
+void SCrvReferenceExplorer::OnExpansionChanged(FCrvExplorerItemPtr Item, const bool bExpanded)
+{
+	if (!bExpanded) { return; }
+	if (Item.IsValid() && !Item->bChildrenRequested)
+	{
+		Item->Children.Reset();
+		RequestChildren(Item);
+		TreeView->RequestTreeRefresh();
+	}
+}
+
+void SCrvReferenceExplorer::OnDoubleClick(FCrvExplorerItemPtr Item) const
+{
+	if (!Item.IsValid() || !Item->Object.IsValid()) { return; }
+	FCrvModule::Get().SelectReference(Item->Object.Get());
+}
+
+void SCrvReferenceExplorer::OnSelectionDelta(const FCrvSet& Added, const FCrvSet& Removed)
+{
+	RequestRefresh();
+}
+
+void SCrvReferenceExplorer::OnSearchCommitted(const FText& Text, const ETextCommit::Type CommitType)
+{
+	if (CommitType != ETextCommit::OnEnter) { return; }
+	const auto Subsystem = GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>();
+	if (!Subsystem) { return; }
+	const auto Matches = Subsystem->NameIndex.Find(Text.ToString(), Explorer::MaxSearchResults);
+	UE_CLOG(FCrvModule::IsDebugEnabled(), LogCrv, Log, TEXT("Explorer search '%s': %d matches of %d indexed"), *Text.ToString(), Matches.Num(), Subsystem->NameIndex.Num());
+	if (!Matches.Num()) { return; }
+
+	GEditor->SelectNone(false, true);
+	for (const auto Match : Matches)
+	{
+		if (const auto Actor = Cast<AActor>(Match))
+		{
+			GEditor->SelectActor(Actor, true, false);
+		}
+		else if (const auto Component = Cast<UActorComponent>(Match))
+		{
+			GEditor->SelectComponent(Component, true, false);
+		}
+	}
+	GEditor->NoteSelectionChange();
+}
+
+void SCrvReferenceExplorer::SetDirection(const ECrvDirection InDirection)
+{
+	if (Direction == InDirection) { return; }
+	Direction = InDirection;
+	RequestRefresh();
+}
+
+void SCrvReferenceExplorer::SetShowCycles(const ECheckBoxState State)
+{
+	const bool bNewShowCycles = State == ECheckBoxState::Checked;
+	if (bShowCycles == bNewShowCycles) { return; }
+	bShowCycles = bNewShowCycles;
+	RequestRefresh();
+}
+
+FText SCrvReferenceExplorer::GetStatusText() const
+{
+	if (!Pending.IsEmpty())
+	{
+		return FText::Format(LOCTEXT("ExplorerPopulating", "{0} rows, populating..."), FText::AsNumber(NumRows));
+	}
+	return FText::Format(LOCTEXT("ExplorerRows", "{0} rows"), FText::AsNumber(NumRows));
+}
+
+#undef LOCTEXT_NAMESPACE
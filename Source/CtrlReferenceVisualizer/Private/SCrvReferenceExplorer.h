@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CrvSettings.h"
+#include "CrvUtils.h"
+#include "Containers/Ticker.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/Views/STreeView.h"
+
+struct FCrvExplorerItem
+{
+	// null for the placeholder row shown until children are populated, and for group rows
+	TWeakObjectPtr<UObject> Object;
+	// shown instead of an object for group rows e.g. a cycle
+	FText GroupLabel;
+	TArray<TSharedPtr<FCrvExplorerItem>> Children;
+	bool bChildrenRequested = false;
+
+	explicit FCrvExplorerItem(UObject* InObject = nullptr)
+		: Object(InObject) {}
+
+	bool IsPlaceholder() const { return Object.IsExplicitlyNull() && GroupLabel.IsEmpty(); }
+	bool IsGroup() const { return !GroupLabel.IsEmpty(); }
+};
+
+using FCrvExplorerItemPtr = TSharedPtr<FCrvExplorerItem>;
+
+/**
+ * Tree of the selection's incoming or outgoing references.
+ * Children are looked up when a row is first expanded, from the subsystem cache when it has them.
+ * Other objects are searched in one batch on the next frame, rows show a loading placeholder until then.
+ * Unsearched rows are searched the same way to find out whether they need an expander.
+ * Rows expanded before a refresh are expanded again as they are added back, each object once so cycles can't expand forever.
+ * Rows are added over several ticks within a time budget so large reference lists don't block Slate.
+ * Searching by name selects the matching objects, which become the tree's roots.
+ * In cycles view the roots are the cached reference cycles, with their actors as children.
+ */
+class SCrvReferenceExplorer : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SCrvReferenceExplorer) {}
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs);
+	virtual ~SCrvReferenceExplorer() override;
+
+	virtual void Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime) override;
+
+private:
+	struct FPendingChildren
+	{
+		TWeakPtr<FCrvExplorerItem> Item;
+		TArray<TWeakObjectPtr<UObject>> Refs;
+		bool bResolved = false;
+		int32 Next = 0;
+	};
+
+	void RequestRefresh();
+	void Refresh();
+	void AddCycleItems();
+	void RequestChildren(const FCrvExplorerItemPtr& Item);
+	void RestoreExpansion(const FCrvExplorerItemPtr& Item);
+	bool PopulatePending(double EndTime);
+	// References from the subsystem cache or an earlier search, null if not searched yet
+	const FCrvWeakSet* FindKnownReferences(UObject* Object) const;
+	void ScheduleSearch();
+	bool SearchPending(float DeltaTime);
+
+	TSharedRef<ITableRow> OnGenerateRow(FCrvExplorerItemPtr Item, const TSharedRef<STableViewBase>& OwnerTable) const;
+	void OnGetChildren(FCrvExplorerItemPtr Item, TArray<FCrvExplorerItemPtr>& OutChildren);
+	void OnExpansionChanged(FCrvExplorerItemPtr Item, bool bExpanded);
+	void OnDoubleClick(FCrvExplorerItemPtr Item) const;
+	void OnSelectionDelta(const FCrvSet& Added, const FCrvSet& Removed);
+	// Select every cached object whose label matches the search
+	void OnSearchCommitted(const FText& Text, ETextCommit::Type CommitType);
+
+	ECrvDirection GetDirection() const { return Direction; }
+	void SetDirection(ECrvDirection InDirection);
+	FText GetStatusText() const;
+	ECheckBoxState GetShowCycles() const { return bShowCycles ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; }
+	void SetShowCycles(ECheckBoxState State);
+
+	ECrvDirection Direction = ECrvDirection::Outgoing;
+	bool bShowCycles = false;
+	TArray<FCrvExplorerItemPtr> RootItems;
+	TSharedPtr<STreeView<FCrvExplorerItemPtr>> TreeView;
+	TArray<FPendingChildren> Pending;
+	// references of objects that aren't roots of the subsystem cache, for the current direction
+	FCrvWeakGraph SearchedRefs;
+	// objects of rows expanded before the last refresh, not added back yet
+	TSet<TObjectKey<UObject>> ExpansionToRestore;
+	// collapsed rows whose references aren't known yet
+	TSet<TWeakObjectPtr<UObject>> ToSearch;
+	FTSTicker::FDelegateHandle SearchTickerHandle;
+	int32 NumRows = 0;
+	bool bRefreshRequested = true;
+
+	FDelegateHandle SelectionDeltaHandle;
+	FDelegateHandle CacheUpdatedHandle;
+};
@@ -0,0 +1,164 @@
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "CrvRefCache.h"
+#include "CrvRefSearch.h"
+#include "CrvSettings.h"
+#include "CrvTestActorBase.h"
+#include "CrvTestTopology.h"
+#include "Editor.h"
+#include "ReferenceVisualizerComponent.h"
+#include "RenderingThread.h"
+
+#include "Dom/JsonObject.h"
+
+#include "Misc/AutomationTest.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include "Serialization/JsonSerializer.h"
+
+using namespace CtrlRefViz::Tests;
+
+namespace CtrlRefViz::Tests
+{
+	static int32 BenchmarkRoots = 100;
+	static FAutoConsoleVariableRef CVarBenchmarkRoots(
+		TEXT("ctrl.ReferenceVisualizer.Benchmark.Roots"),
+		BenchmarkRoots,
+		TEXT("Number of root actors searched by the reference visualizer benchmarks, spread evenly over the level")
+	);
+
+	static int32 BenchmarkRefsPerActor = 4;
+	static FAutoConsoleVariableRef CVarBenchmarkRefsPerActor(
+		TEXT("ctrl.ReferenceVisualizer.Benchmark.RefsPerActor"),
+		BenchmarkRefsPerActor,
+		TEXT("Number of random references written to each actor spawned by the reference visualizer benchmarks")
+	);
+
+	static int32 CountEdges(const FCrvObjectGraph& Graph)
+	{
+		int32 Num = 0;
+		for (const auto& [Root, Refs] : Graph)
+		{
+			Num += Refs.Num();
+		}
+		return Num;
+	}
+}
+
+/**
+ * Times each stage of the reference pipeline on generated levels of test actors.
+ * Writes one JSON file per level size to Saved/Automation/CrvBenchmark, so scaling can be compared across versions.
+ * Runs headless e.g. -nullrhi -ExecCmds="Automation RunTests CtrlReferenceVisualizer.Benchmark"
+ */
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(
+	FCrvBenchmarkTest,
+	"CtrlReferenceVisualizer.Benchmark",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter
+)
+
+void FCrvBenchmarkTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	for (const int32 NumActors : {100, 1000, 10000, 50000})
+	{
+		OutBeautifiedNames.Add(FString::Printf(TEXT("%d Actors"), NumActors));
+		OutTestCommands.Add(FString::FromInt(NumActors));
+	}
+}
+
+bool FCrvBenchmarkTest::RunTest(const FString& Parameters)
+{
+	const auto Subsystem = GEditor ? GEditor->GetEditorSubsystem<UReferenceVisualizerEditorSubsystem>() : nullptr;
+	if (!TestNotNull(TEXT("Reference visualizer subsystem"), Subsystem)) { return false; }
+
+	FCrvTestWorld TestWorld;
+	FCrvTopologySettings Settings;
+	Settings.NumActors = FCString::Atoi(*Parameters);
+	Settings.RefsPerActor = BenchmarkRefsPerActor;
+	Settings.Seed = Settings.NumActors;
+
+	const auto Result = MakeShared<FJsonObject>();
+	Result->SetNumberField(TEXT("Actors"), Settings.NumActors);
+	Result->SetNumberField(TEXT("RefsPerActor"), Settings.RefsPerActor);
+	Result->SetStringField(TEXT("EngineVersion"), FEngineVersion::Current().ToString());
+	Result->SetStringField(TEXT("Timestamp"), FDateTime::UtcNow().ToIso8601());
+	const auto Timings = MakeShared<FJsonObject>();
+	auto Time = [&Timings](const TCHAR* Stage, TFunctionRef<void()> Function)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		Function();
+		const double Milliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		Timings->SetNumberField(Stage, Milliseconds);
+		return Milliseconds;
+	};
+
+	TArray<ACrvTestActorBase*> Actors;
+	Time(TEXT("Spawn"), [&]() { Actors = SpawnTopology(TestWorld.GetWorld(), Settings); });
+	if (!TestEqual(TEXT("Spawned actors"), Actors.Num(), Settings.NumActors)) { return false; }
+
+	FCrvSet Roots;
+	const int32 NumRoots = FMath::Clamp(BenchmarkRoots, 1, Actors.Num());
+	for (int32 Index = 0; Index < NumRoots; ++Index)
+	{
+		Roots.Add(Actors[Index * Actors.Num() / NumRoots]);
+	}
+	Result->SetNumberField(TEXT("Roots"), Roots.Num());
+
+	FCrvObjectGraph OutRefs;
+	FCrvObjectGraph InRefs;
+	Time(TEXT("FindOutRefs"), [&]() { FCrvRefSearch::FindOutRefs(Roots, OutRefs); });
+	Time(TEXT("FindInRefs"), [&]() { FCrvRefSearch::FindInRefs(Roots, InRefs); });
+	Result->SetNumberField(TEXT("OutgoingEdges"), CountEdges(OutRefs));
+	Result->SetNumberField(TEXT("IncomingEdges"), CountEdges(InRefs));
+
+	// fills the subsystem cache, so the visualizer components added to the roots draw from it
+	const auto Cache = Subsystem->Cache;
+	const auto EditorRoots = ResolveWeakSet(Cache->WeakRootObjects);
+	TArray<FDebugRenderSceneProxy*> Proxies;
+	{
+		TGuardValue<bool> AutoAddComponents(GetMutableDefault<UCrvSettings>()->bAutoAddComponents, true);
+		Cache->Reset(TEXT("Benchmark"));
+		Time(TEXT("FillCache"), [&]() { Cache->FillCache(Roots); });
+
+		Time(TEXT("CreateDebugSceneProxy"), [&]()
+		{
+			for (const auto Root : Roots)
+			{
+				if (const auto Component = CastChecked<AActor>(Root)->FindComponentByClass<UReferenceVisualizerComponent>())
+				{
+					Proxies.Add(Component->CreateDebugSceneProxy());
+				}
+			}
+		});
+	}
+	Result->SetNumberField(TEXT("Proxies"), Proxies.Num());
+	TestEqual(TEXT("A proxy per root"), Proxies.Num(), Roots.Num());
+	ENQUEUE_RENDER_COMMAND(CrvDeleteBenchmarkProxies)(
+		[Proxies = MoveTemp(Proxies)](FRHICommandListImmediate&)
+		{
+			for (const auto Proxy : Proxies)
+			{
+				delete Proxy;
+			}
+		}
+	);
+	FlushRenderingCommands();
+
+	// back to the editor's own roots
+	Cache->Reset(TEXT("Benchmark finished"));
+	Cache->FillCache(EditorRoots);
+	Result->SetObjectField(TEXT("TimingsMs"), Timings);
+
+	FString Json;
+	const auto Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Result, Writer);
+	const auto Path = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Automation"), TEXT("CrvBenchmark"), FString::Printf(TEXT("CrvBenchmark_%d.json"), Settings.NumActors));
+	TestTrue(FString::Printf(TEXT("Write %s"), *Path), FFileHelper::SaveStringToFile(Json, *Path));
+	AddInfo(Json);
+	return true;
+}
+
+#endif
@@ -0,0 +1,208 @@
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "CrvCycleIndex.h"
+#include "CrvRefCache.h"
+#include "CrvSettings.h"
+#include "CrvTestActorBase.h"
+#include "CrvTestTopology.h"
+
+#include "Misc/AutomationTest.h"
+
+namespace CtrlRefViz::Tests
+{
+	static TArray<int32> RandomEdges(FRandomStream& Random, const int32 NumNodes, const int32 MaxEdges)
+	{
+		TArray<int32> Targets;
+		const int32 NumEdges = Random.RandRange(0, MaxEdges);
+		for (int32 Index = 0; Index < NumEdges; ++Index)
+		{
+			Targets.Add(Random.RandHelper(NumNodes));
+		}
+		return Targets;
+	}
+
+	static FString MakePair(const int32 A, const int32 B)
+	{
+		return FString::Printf(TEXT("cycle pair %d & %d"), A, B);
+	}
+
+	// Nodes are in the same cycle when they reach each other, found by walking from every node
+	static FString FindFirstCycleMismatch(const FCrvSccGraph& Graph)
+	{
+		const int32 NumNodes = Graph.NumNodes();
+		TArray<TBitArray<>> Reaches;
+		for (int32 From = 0; From < NumNodes; ++From)
+		{
+			auto& Reached = Reaches.Emplace_GetRef(false, NumNodes);
+			TArray<int32> Stack = {From};
+			while (Stack.Num())
+			{
+				for (const int32 Target : Graph.GetEdges(Stack.Pop()))
+				{
+					if (Reached[Target]) { continue; }
+					Reached[Target] = true;
+					Stack.Add(Target);
+				}
+			}
+		}
+		TArray<FString> Expected;
+		TArray<FString> Actual;
+		for (int32 A = 0; A < NumNodes; ++A)
+		{
+			for (int32 B = A + 1; B < NumNodes; ++B)
+			{
+				if (Reaches[A][B] && Reaches[B][A])
+				{
+					Expected.Add(MakePair(A, B));
+				}
+				if (Graph.GetCycle(A) != INDEX_NONE && Graph.GetCycle(A) == Graph.GetCycle(B))
+				{
+					Actual.Add(MakePair(A, B));
+				}
+			}
+		}
+		Expected.Sort();
+		Actual.Sort();
+		return FindFirstMismatch(Expected, Actual);
+	}
+}
+
+using namespace CtrlRefViz::Tests;
+
+/**
+ * Compares cycles of random graphs, after a rebuild & after each incremental edit, against brute force reachability.
+ */
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(
+	FCrvSccGraphTest,
+	"CtrlReferenceVisualizer.Cycles.Components",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter
+)
+
+void FCrvSccGraphTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	GetSeedTests(8, OutBeautifiedNames, OutTestCommands);
+}
+
+bool FCrvSccGraphTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(FCString::Atoi(*Parameters));
+	constexpr int32 NumNodes = 60;
+	FCrvSccGraph Graph;
+	Graph.SetNumNodes(NumNodes);
+	for (int32 Node = 0; Node < NumNodes; ++Node)
+	{
+		Graph.SetEdges(Node, RandomEdges(Random, NumNodes, 2));
+	}
+	Graph.Rebuild();
+	const auto RebuildMismatch = FindFirstCycleMismatch(Graph);
+	if (!TestTrue(FString::Printf(TEXT("Rebuild: %s"), *RebuildMismatch), RebuildMismatch.IsEmpty())) { return false; }
+
+	// a few nodes change per update, like selection & property edits
+	for (int32 Step = 0; Step < 50; ++Step)
+	{
+		const int32 NumChanged = Random.RandRange(1, 3);
+		for (int32 Index = 0; Index < NumChanged; ++Index)
+		{
+			Graph.SetEdges(Random.RandHelper(NumNodes), RandomEdges(Random, NumNodes, 3));
+		}
+		Graph.Update();
+		const auto Mismatch = FindFirstCycleMismatch(Graph);
+		if (!TestTrue(FString::Printf(TEXT("Step %d: %s"), Step, *Mismatch), Mismatch.IsEmpty())) { return false; }
+	}
+	return true;
+}
+
+/**
+ * A 100k node chain closed into one cycle, plus random edges.
+ * The chain is deeper than a recursive search could handle, timings are reported rather than asserted.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FCrvSccGraphScaleTest,
+	"CtrlReferenceVisualizer.Cycles.Scale",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter
+)
+
+bool FCrvSccGraphScaleTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumNodes = 100000;
+	FRandomStream Random(NumNodes);
+	FCrvSccGraph Graph;
+	Graph.SetNumNodes(NumNodes);
+	for (int32 Node = 0; Node < NumNodes; ++Node)
+	{
+		auto Targets = RandomEdges(Random, NumNodes, 3);
+		Targets.Add((Node + 1) % NumNodes);
+		Graph.SetEdges(Node, MoveTemp(Targets));
+	}
+	const double StartTime = FPlatformTime::Seconds();
+	Graph.Rebuild();
+	const double RebuildSeconds = FPlatformTime::Seconds() - StartTime;
+	AddInfo(FString::Printf(TEXT("Rebuild of %d nodes: %.1fms"), NumNodes, RebuildSeconds * 1000.0));
+	TestEqual(TEXT("Cycles"), Graph.GetCycles().Num(), 1);
+	TestEqual(TEXT("Node 0 & last node share a cycle"), Graph.GetCycle(0), Graph.GetCycle(NumNodes - 1));
+
+	// opening the chain splits the cycle, random edges may still keep parts of it together
+	Graph.SetEdges(NumNodes - 1, {});
+	const double UpdateStartTime = FPlatformTime::Seconds();
+	Graph.Update();
+	AddInfo(FString::Printf(TEXT("Update after removing an edge: %.1fms"), (FPlatformTime::Seconds() - UpdateStartTime) * 1000.0));
+	TestEqual(TEXT("Last node has no cycle"), Graph.GetCycle(NumNodes - 1), INDEX_NONE);
+	return true;
+}
+
+/**
+ * Cycles found by an index listening to a reference cache, as the subsystem keeps it, after a full fill & a root delta.
+ * A -> B -> C -> A is a cycle, with B's reference held by its component & D only referencing into it.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FCrvCycleIndexCacheTest,
+	"CtrlReferenceVisualizer.Cycles.Cache",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter
+)
+
+bool FCrvCycleIndexCacheTest::RunTest(const FString& Parameters)
+{
+	auto* Settings = GetMutableDefault<UCrvSettings>();
+	TGuardValue<bool> ShowOutgoing(Settings->bShowOutgoingReferences, true);
+	TGuardValue<bool> AutoAddComponents(Settings->bAutoAddComponents, false);
+
+	FCrvTestWorld TestWorld;
+	FCrvTopologySettings TopologySettings;
+	TopologySettings.NumActors = 4;
+	TopologySettings.RefsPerActor = 0;
+	const auto Actors = SpawnTopology(TestWorld.GetWorld(), TopologySettings);
+	if (!TestEqual(TEXT("Spawned actors"), Actors.Num(), TopologySettings.NumActors)) { return false; }
+	const auto A = Actors[0];
+	const auto B = Actors[1];
+	const auto C = Actors[2];
+	const auto D = Actors[3];
+	A->ActorRef = B;
+	B->TestComponent->ActorRef = C;
+	C->ActorRefArray.Add(A);
+	D->ActorRef = A;
+
+	const auto Cache = NewObject<UCrvRefCache>(GetTransientPackage());
+	FCrvCycleIndex CycleIndex;
+	Cache->OnCacheUpdated.AddLambda([Cache, &CycleIndex]()
+	{
+		CycleIndex.Update(Cache->GetValidCached(ECrvDirection::Outgoing));
+	});
+
+	Cache->FillCache({A, B, C, D});
+	TestEqual(TEXT("Cycles after fill"), CycleIndex.NumCycles(), 1);
+	TestTrue(TEXT("A & C share a cycle"), CycleIndex.IsInSameCycle(A, C));
+	TestTrue(TEXT("B's component is in the cycle"), CycleIndex.IsInCycle(B->TestComponent));
+	TestFalse(TEXT("D is not in a cycle"), CycleIndex.IsInCycle(D));
+
+	// without C's references the cycle is no longer known
+	Cache->ApplyRootDelta({}, {C});
+	TestEqual(TEXT("Cycles after removing a root"), CycleIndex.NumCycles(), 0);
+
+	Cache->OnCacheUpdated.Clear();
+	Cache->MarkAsGarbage();
+	return true;
+}
+
+#endif
@@ -0,0 +1,140 @@
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "CrvRefCache.h"
+#include "CrvRefSearch.h"
+#include "CrvSettings.h"
+#include "CrvTestActorBase.h"
+#include "CrvTestTopology.h"
+#include "CrvUtils.h"
+
+#include "Misc/AutomationTest.h"
+
+using namespace CtrlRefViz::Tests;
+
+namespace CtrlRefViz::Tests
+{
+	using FCrvSearchFunction = TFunction<void(const FCrvSet& Roots, FCrvObjectGraph& OutGraph)>;
+
+	// A search implementation that must produce exactly the edges of FCrvRefSearch::FindOutRefs & FindInRefs
+	struct FCrvSearchEngine
+	{
+		FString Name;
+		FCrvSearchFunction FindOutRefs;
+		FCrvSearchFunction FindInRefs;
+	};
+
+	// Roots added to & removed from a filled cache in batches, as selection deltas do
+	static FCrvSearchFunction SearchIncrementalCache(const ECrvDirection Direction)
+	{
+		return [Direction](const FCrvSet& Roots, FCrvObjectGraph& OutGraph)
+		{
+			auto* Settings = GetMutableDefault<UCrvSettings>();
+			TGuardValue<bool> ShowOutgoing(Settings->bShowOutgoingReferences, true);
+			TGuardValue<bool> ShowIncoming(Settings->bShowIncomingReferences, true);
+			TGuardValue<bool> AutoAddComponents(Settings->bAutoAddComponents, false);
+
+			const auto Cache = NewObject<UCrvRefCache>(GetTransientPackage());
+			const auto RootsArray = Roots.Array();
+			const auto Slice = [&RootsArray](const int32 Start, const int32 End)
+			{
+				FCrvSet Slice;
+				for (int32 Index = Start; Index < End; ++Index)
+				{
+					Slice.Add(RootsArray[Index]);
+				}
+				return Slice;
+			};
+			const int32 NumFirst = FMath::Max(1, RootsArray.Num() / 3);
+			const int32 NumSecond = NumFirst + (RootsArray.Num() - NumFirst) / 2;
+			Cache->FillCache(Slice(0, NumFirst));
+			// add the rest in two batches, removing & re-adding the first root along the way
+			Cache->ApplyRootDelta(Slice(NumFirst, NumSecond), {});
+			Cache->ApplyRootDelta({}, Slice(0, 1));
+			auto Rest = Slice(NumSecond, RootsArray.Num());
+			Rest.Add(RootsArray[0]);
+			Cache->ApplyRootDelta(Rest, {});
+
+			OutGraph = ResolveWeakGraph(Direction == ECrvDirection::Outgoing ? Cache->Outgoing : Cache->Incoming);
+			Cache->MarkAsGarbage();
+		};
+	}
+
+	static TArray<FCrvSearchEngine> GetSearchEngines()
+	{
+		return {
+			{TEXT("IncrementalCache"), SearchIncrementalCache(ECrvDirection::Outgoing), SearchIncrementalCache(ECrvDirection::Incoming)},
+			{TEXT("BatchedInRefs"), &FCrvRefSearch::FindOutRefs, &FCrvRefSearch::FindInRefsBatched},
+		};
+	}
+
+	// Edges as "Root -> Leaf" path names, sorted so graphs compare in a stable order
+	static TArray<FString> GetSortedEdges(const FCrvObjectGraph& Graph)
+	{
+		TArray<FString> Edges;
+		for (const auto& [Root, Leaves] : Graph)
+		{
+			for (const auto Leaf : Leaves)
+			{
+				Edges.Add(FString::Printf(TEXT("%s -> %s"), *GetPathNameSafe(Root), *GetPathNameSafe(Leaf)));
+			}
+		}
+		Edges.Sort();
+		return Edges;
+	}
+}
+
+/**
+ * Runs every search engine against FCrvRefSearch::FindOutRefs & FindInRefs on random levels.
+ * Levels mix nested structs, containers, child actors & instanced subobjects.
+ * Fails with the first edge that differs, add new search implementations to GetSearchEngines.
+ */
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(
+	FCrvDifferentialSearchTest,
+	"CtrlReferenceVisualizer.Search.Differential",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter
+)
+
+void FCrvDifferentialSearchTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	GetSeedTests(8, OutBeautifiedNames, OutTestCommands);
+}
+
+bool FCrvDifferentialSearchTest::RunTest(const FString& Parameters)
+{
+	FCrvTestWorld TestWorld;
+	FCrvTopologySettings Settings;
+	Settings.Seed = FCString::Atoi(*Parameters);
+	Settings.NumActors = 200;
+	Settings.RefsPerActor = 6;
+	Settings.ChildActorFraction = 0.25f;
+	const auto Actors = SpawnTopology(TestWorld.GetWorld(), Settings);
+	if (!TestEqual(TEXT("Spawned actors"), Actors.Num(), Settings.NumActors)) { return false; }
+
+	FRandomStream Random(Settings.Seed);
+	FCrvSet Roots;
+	for (int32 Index = 0; Index < 20; ++Index)
+	{
+		Roots.Add(Actors[Random.RandHelper(Actors.Num())]);
+	}
+
+	FCrvObjectGraph ExpectedOut;
+	FCrvObjectGraph ExpectedIn;
+	FCrvRefSearch::FindOutRefs(Roots, ExpectedOut);
+	FCrvRefSearch::FindInRefs(Roots, ExpectedIn);
+	for (const auto& Engine : GetSearchEngines())
+	{
+		FCrvObjectGraph ActualOut;
+		FCrvObjectGraph ActualIn;
+		Engine.FindOutRefs(Roots, ActualOut);
+		Engine.FindInRefs(Roots, ActualIn);
+		const auto OutMismatch = FindFirstMismatch(GetSortedEdges(ExpectedOut), GetSortedEdges(ActualOut));
+		const auto InMismatch = FindFirstMismatch(GetSortedEdges(ExpectedIn), GetSortedEdges(ActualIn));
+		TestTrue(FString::Printf(TEXT("%s outgoing: %s"), *Engine.Name, *OutMismatch), OutMismatch.IsEmpty());
+		TestTrue(FString::Printf(TEXT("%s incoming: %s"), *Engine.Name, *InMismatch), InMismatch.IsEmpty());
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,82 @@
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "CrvGraphDiff.h"
+
+#include "Misc/AutomationTest.h"
+
+namespace CtrlRefViz::Tests
+{
+	static int32 AddNode(FCrvGraphSnapshot& Snapshot, const TCHAR* Key, const TCHAR* PathName, const bool bIsRoot)
+	{
+		return Snapshot.Nodes.Add({Key, PathName, Key, bIsRoot});
+	}
+
+	static void AddEdge(FCrvGraphSnapshot& Snapshot, const int32 Root, const int32 Leaf, const ECrvDirection Direction = ECrvDirection::Outgoing)
+	{
+		Snapshot.Edges.Add({Direction, Root, Leaf});
+	}
+}
+
+using namespace CtrlRefViz::Tests;
+
+/**
+ * Compares hand built snapshots: actors matched by guid across renames, added & removed edges, and shared roots only.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FCrvGraphDiffTest,
+	"CtrlReferenceVisualizer.GraphDiff.Compare",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter
+)
+
+bool FCrvGraphDiffTest::RunTest(const FString& Parameters)
+{
+	// A is renamed between snapshots & keeps its guid, its reference moves from B to C
+	FCrvGraphSnapshot Old;
+	const int32 OldA = AddNode(Old, TEXT("GuidA"), TEXT("/Game/Map.Map:PersistentLevel.OldA"), true);
+	const int32 OldB = AddNode(Old, TEXT("GuidB"), TEXT("/Game/Map.Map:PersistentLevel.B"), false);
+	const int32 OldD = AddNode(Old, TEXT("GuidD"), TEXT("/Game/Map.Map:PersistentLevel.D"), true);
+	AddEdge(Old, OldA, OldB);
+	AddEdge(Old, OldD, OldB);
+	AddEdge(Old, OldA, OldB, ECrvDirection::Incoming);
+
+	FCrvGraphSnapshot New;
+	const int32 NewC = AddNode(New, TEXT("GuidC"), TEXT("/Game/Map.Map:PersistentLevel.C"), false);
+	const int32 NewA = AddNode(New, TEXT("GuidA"), TEXT("/Game/Map.Map:PersistentLevel.NewA"), true);
+	const int32 NewB = AddNode(New, TEXT("GuidB"), TEXT("/Game/Map.Map:PersistentLevel.B"), false);
+	AddEdge(New, NewA, NewC);
+	AddEdge(New, NewA, NewB, ECrvDirection::Incoming);
+
+	const auto Unchanged = FCrvGraphDiff::Compare(Old, Old);
+	TestEqual(TEXT("Same snapshot has no changes"), Unchanged.Changes.Num(), 0);
+
+	// D is only a root in the old snapshot, so its edge is removed
+	const auto Diff = FCrvGraphDiff::Compare(Old, New);
+	TestEqual(TEXT("Added"), Diff.NumAdded(), 1);
+	TestEqual(TEXT("Removed"), Diff.NumRemoved(), 2);
+	for (const auto& Change : Diff.Changes)
+	{
+		TestTrue(TEXT("Only outgoing edges changed, the renamed root's incoming edge matched by guid"), Change.Direction == ECrvDirection::Outgoing);
+		if (Change.bAdded)
+		{
+			TestEqual(TEXT("Added root described by the new snapshot"), Change.RootPath, FString(TEXT("/Game/Map.Map:PersistentLevel.NewA")));
+			TestEqual(TEXT("Added leaf"), Change.LeafPath, FString(TEXT("/Game/Map.Map:PersistentLevel.C")));
+		}
+		else
+		{
+			TestEqual(TEXT("Removed leaf"), Change.LeafPath, FString(TEXT("/Game/Map.Map:PersistentLevel.B")));
+		}
+	}
+
+	const auto Shared = FCrvGraphDiff::Compare(Old, New, true);
+	TestEqual(TEXT("Shared roots added"), Shared.NumAdded(), 1);
+	TestEqual(TEXT("Shared roots removed"), Shared.NumRemoved(), 1);
+	for (const auto& Change : Shared.Changes)
+	{
+		TestEqual(TEXT("Only A is a root in both"), Change.RootPath, FString(TEXT("/Game/Map.Map:PersistentLevel.NewA")));
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,188 @@
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "CrvGraphFile.h"
+#include "CrvTestActorBase.h"
+#include "CrvTestTopology.h"
+
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+using namespace CtrlRefViz::Tests;
+
+namespace CtrlRefViz::Tests
+{
+	static FString GetGraphFileTestPath(const TCHAR* Name)
+	{
+		return FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("CrvGraphFile"), FString(Name) + TEXT(".crvg"));
+	}
+
+	// A -> B, A -> D, B -> C outgoing & C <- A incoming, D is only a leaf
+	static TArray64<uint8> WriteTestGraph(const TArray<ACrvTestActorBase*>& Actors)
+	{
+		FCrvObjectGraph Outgoing;
+		Outgoing.Add(Actors[0], {Actors[1], Actors[3]});
+		Outgoing.Add(Actors[1], {Actors[2]});
+		FCrvObjectGraph Incoming;
+		Incoming.Add(Actors[2], {Actors[0]});
+		return FCrvGraphFile::Write(Outgoing, Incoming);
+	}
+
+	static FCrvGraphFileHeader& GetHeader(TArray64<uint8>& Bytes)
+	{
+		return *reinterpret_cast<FCrvGraphFileHeader*>(Bytes.GetData());
+	}
+
+	static uint32* GetSection(TArray64<uint8>& Bytes, const uint64 Offset)
+	{
+		return reinterpret_cast<uint32*>(Bytes.GetData() + Offset);
+	}
+
+	static TUniquePtr<FCrvGraphFile> SaveAndOpen(const TCHAR* Name, const TArray64<uint8>& Bytes)
+	{
+		const auto Path = GetGraphFileTestPath(Name);
+		if (!FFileHelper::SaveArrayToFile(Bytes, *Path)) { return nullptr; }
+		return FCrvGraphFile::Open(Path);
+	}
+}
+
+/**
+ * Writes a small graph, opens it again & reads back nodes, names & edges of both directions.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FCrvGraphFileRoundTripTest,
+	"CtrlReferenceVisualizer.GraphFile.RoundTrip",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter
+)
+
+bool FCrvGraphFileRoundTripTest::RunTest(const FString& Parameters)
+{
+	FCrvTestWorld TestWorld;
+	FCrvTopologySettings Settings;
+	Settings.NumActors = 4;
+	Settings.RefsPerActor = 0;
+	const auto Actors = SpawnTopology(TestWorld.GetWorld(), Settings);
+	if (!TestEqual(TEXT("Spawned actors"), Actors.Num(), Settings.NumActors)) { return false; }
+
+	const auto File = SaveAndOpen(TEXT("RoundTrip"), WriteTestGraph(Actors));
+	if (!TestNotNull(TEXT("Opened"), File.Get())) { return false; }
+	TestEqual(TEXT("Nodes"), File->NumNodes(), 4);
+	TestEqual(TEXT("Outgoing edges"), File->NumEdges(ECrvDirection::Outgoing), 3);
+	TestEqual(TEXT("Incoming edges"), File->NumEdges(ECrvDirection::Incoming), 1);
+
+	TArray<int32> Nodes;
+	for (const auto Actor : Actors)
+	{
+		const auto PathName = Actor->GetPathName();
+		const int32 Node = File->FindNode(PathName);
+		TestNotEqual(FString::Printf(TEXT("Find %s"), *PathName), Node, static_cast<int32>(INDEX_NONE));
+		if (Node == INDEX_NONE) { return false; }
+		TestEqual(TEXT("Path name"), File->GetPathName(Node), PathName);
+		TestTrue(TEXT("Actor guid"), File->GetNode(Node).ActorGuid == Actor->GetActorInstanceGuid());
+		Nodes.Add(Node);
+	}
+	TestEqual(TEXT("Missing path"), File->FindNode(TEXT("/Game/Missing.Missing:PersistentLevel.Missing")), static_cast<int32>(INDEX_NONE));
+	for (int32 Node = 1; Node < File->NumNodes(); ++Node)
+	{
+		TestTrue(TEXT("Nodes sorted by path"), File->GetPathName(Node - 1).Compare(File->GetPathName(Node), ESearchCase::CaseSensitive) < 0);
+	}
+
+	TestTrue(TEXT("A is a root"), File->GetNode(Nodes[0]).bIsRoot != 0);
+	TestTrue(TEXT("C is a root"), File->GetNode(Nodes[2]).bIsRoot != 0);
+	TestTrue(TEXT("D is only a leaf"), File->GetNode(Nodes[3]).bIsRoot == 0);
+
+	const auto OutOfA = File->GetEdges(Nodes[0], ECrvDirection::Outgoing);
+	TestEqual(TEXT("Outgoing edges of A"), OutOfA.Num(), 2);
+	TestTrue(TEXT("A -> B"), OutOfA.Contains(static_cast<uint32>(Nodes[1])));
+	TestTrue(TEXT("A -> D"), OutOfA.Contains(static_cast<uint32>(Nodes[3])));
+	TestTrue(TEXT("Edges sorted by target"), OutOfA.Num() == 2 && OutOfA[0] < OutOfA[1]);
+	const auto IntoC = File->GetEdges(Nodes[2], ECrvDirection::Incoming);
+	TestTrue(TEXT("C <- A"), IntoC.Num() == 1 && IntoC[0] == static_cast<uint32>(Nodes[0]));
+	TestEqual(TEXT("No outgoing edges of D"), File->GetEdges(Nodes[3], ECrvDirection::Outgoing).Num(), 0);
+	return true;
+}
+
+/**
+ * Damaged files must fail to open instead of being read out of bounds.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FCrvGraphFileValidationTest,
+	"CtrlReferenceVisualizer.GraphFile.Validation",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter
+)
+
+bool FCrvGraphFileValidationTest::RunTest(const FString& Parameters)
+{
+	FCrvTestWorld TestWorld;
+	FCrvTopologySettings Settings;
+	Settings.NumActors = 4;
+	Settings.RefsPerActor = 0;
+	const auto Actors = SpawnTopology(TestWorld.GetWorld(), Settings);
+	if (!TestEqual(TEXT("Spawned actors"), Actors.Num(), Settings.NumActors)) { return false; }
+	const auto Valid = WriteTestGraph(Actors);
+	if (!TestNotNull(TEXT("Valid file opens"), SaveAndOpen(TEXT("Valid"), Valid).Get())) { return false; }
+
+	AddExpectedError(TEXT("Not a reference graph file"), EAutomationExpectedErrorFlags::Contains, 1);
+	AddExpectedError(TEXT("Unsupported reference graph file version"), EAutomationExpectedErrorFlags::Contains, 1);
+	AddExpectedError(TEXT("truncated or corrupt"), EAutomationExpectedErrorFlags::Contains, 0);
+
+	{
+		auto Bytes = Valid;
+		GetHeader(Bytes).Magic = 0;
+		TestNull(TEXT("Wrong magic"), SaveAndOpen(TEXT("WrongMagic"), Bytes).Get());
+	}
+	{
+		auto Bytes = Valid;
+		GetHeader(Bytes).Version = FCrvGraphFileHeader::CurrentVersion + 1;
+		TestNull(TEXT("Wrong version"), SaveAndOpen(TEXT("WrongVersion"), Bytes).Get());
+	}
+	{
+		auto Bytes = Valid;
+		Bytes.SetNum(Bytes.Num() - sizeof(uint32));
+		TestNull(TEXT("Truncated"), SaveAndOpen(TEXT("Truncated"), Bytes).Get());
+	}
+	{
+		auto Bytes = Valid;
+		Bytes.SetNum(sizeof(FCrvGraphFileHeader) / 2);
+		TestNull(TEXT("Truncated header"), SaveAndOpen(TEXT("TruncatedHeader"), Bytes).Get());
+	}
+	{
+		auto Bytes = Valid;
+		GetHeader(Bytes).Nodes += 4;
+		TestNull(TEXT("Misaligned section"), SaveAndOpen(TEXT("MisalignedSection"), Bytes).Get());
+	}
+	{
+		auto Bytes = Valid;
+		GetHeader(Bytes).OutEdges = GetHeader(Bytes).FileSize;
+		TestNull(TEXT("Section past the end"), SaveAndOpen(TEXT("SectionPastEnd"), Bytes).Get());
+	}
+	{
+		auto Bytes = Valid;
+		auto& Header = GetHeader(Bytes);
+		GetSection(Bytes, Header.OutOffsets)[Header.NumNodes] = Header.NumOutEdges + 1;
+		TestNull(TEXT("Row offsets past the edges"), SaveAndOpen(TEXT("BadRowOffset"), Bytes).Get());
+	}
+	{
+		auto Bytes = Valid;
+		auto& Header = GetHeader(Bytes);
+		GetSection(Bytes, Header.NameOffsets)[1] = MAX_uint32;
+		TestNull(TEXT("Name offsets out of order"), SaveAndOpen(TEXT("BadNameOffset"), Bytes).Get());
+	}
+	{
+		auto Bytes = Valid;
+		auto& Header = GetHeader(Bytes);
+		GetSection(Bytes, Header.InEdges)[0] = Header.NumNodes;
+		TestNull(TEXT("Edge to a missing node"), SaveAndOpen(TEXT("BadEdge"), Bytes).Get());
+	}
+	{
+		auto Bytes = Valid;
+		auto& Header = GetHeader(Bytes);
+		reinterpret_cast<FCrvGraphFileNode*>(Bytes.GetData() + Header.Nodes)[0].Label = Header.NumNames;
+		TestNull(TEXT("Node name out of range"), SaveAndOpen(TEXT("BadName"), Bytes).Get());
+	}
+	return true;
+}
+
+#endif
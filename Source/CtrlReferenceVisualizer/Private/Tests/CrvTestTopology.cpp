@@ -0,0 +1,133 @@
+#include "CrvTestTopology.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "CrvTestActorBase.h"
+#include "Editor.h"
+#include "Engine/World.h"
+#include "Components/ChildActorComponent.h"
+
+namespace CtrlRefViz::Tests
+{
+	FCrvTestWorld::FCrvTestWorld()
+	{
+		World = UWorld::CreateWorld(EWorldType::Editor, false, TEXT("CrvTestWorld"));
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Editor);
+		WorldContext.SetCurrentWorld(World);
+	}
+
+	FCrvTestWorld::~FCrvTestWorld()
+	{
+		if (!World) { return; }
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	static void WriteReference(ACrvTestActorBase* Actor, AActor* Target, const int32 Kind)
+	{
+		const auto TargetComponent = Target->GetRootComponent();
+		switch (Kind)
+		{
+			case 0: Actor->ActorRef = Target; break;
+			case 1: Actor->ActorRef2 = Target; break;
+			case 2: Actor->SoftActorRef = Target; break;
+			case 3: Actor->WeakActorRef = Target; break;
+			case 4: Actor->ActorRefArray.Add(Target); break;
+			case 5: Actor->ActorRefMap.Add(Target, Actor->ActorRefMap.Num()); break;
+			case 6: Actor->ComponentRef = TargetComponent; break;
+			case 7: Actor->WeakComponentRef = TargetComponent; break;
+			// nested
+			case 8: Actor->TestStruct.ActorRefArray.Add(Target); break;
+			case 9: Actor->TestStruct.TestStructNested.ActorRef = Target; break;
+			case 10: Actor->TestObject->ActorRefMap.Add(Target, 0); break;
+			case 11: Actor->TestComponent->ActorRef = Target; break;
+			case 12: Actor->TestComponent->TestObject->TestStruct.SoftActorRef = Target; break;
+			default:
+			{
+				// instanced subobject held in a struct
+				if (!Actor->TestStruct.TestObject)
+				{
+					Actor->TestStruct.TestObject = NewObject<UCrvTestObject>(Actor);
+				}
+				Actor->TestStruct.TestObject->WeakActorRef = Target;
+				break;
+			}
+		}
+	}
+
+	TArray<ACrvTestActorBase*> SpawnTopology(UWorld* World, const FCrvTopologySettings& Settings)
+	{
+		TArray<ACrvTestActorBase*> Actors;
+		if (!World || Settings.NumActors <= 0) { return Actors; }
+		FRandomStream Random(Settings.Seed);
+		const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Settings.NumActors)));
+		Actors.Reserve(Settings.NumActors);
+		for (int32 Index = 0; Index < Settings.NumActors; ++Index)
+		{
+			const FVector Location((Index % GridSize) * Settings.Spacing, (Index / GridSize) * Settings.Spacing, 0.0);
+			const bool bWithChildActor = Random.FRand() < Settings.ChildActorFraction;
+			const auto Class = bWithChildActor ? ACrvTestActorWithChildActorBase::StaticClass() : ACrvTestActorBase::StaticClass();
+			FActorSpawnParameters SpawnParameters;
+			SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+			if (const auto Actor = World->SpawnActor<ACrvTestActorBase>(Class, FTransform(Location), SpawnParameters))
+			{
+				Actors.Add(Actor);
+			}
+		}
+
+		const int32 NumKinds = Settings.bNestedReferences ? 14 : 8;
+		for (const auto Actor : Actors)
+		{
+			for (int32 Ref = 0; Ref < Settings.RefsPerActor; ++Ref)
+			{
+				const auto Target = Actors[Random.RandHelper(Actors.Num())];
+				if (Target == Actor) { continue; }
+				WriteReference(Actor, Target, Random.RandHelper(NumKinds));
+			}
+			if (const auto WithChild = Cast<ACrvTestActorWithChildActorBase>(Actor))
+			{
+				// child actors reference back out into the level
+				if (const auto Child = Cast<ACrvTestActorBase>(WithChild->ChildActorComponent->GetChildActor()))
+				{
+					WriteReference(Child, Actors[Random.RandHelper(Actors.Num())], Random.RandHelper(NumKinds));
+				}
+			}
+		}
+		return Actors;
+	}
+
+	void GetSeedTests(const int32 NumSeeds, TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands)
+	{
+		for (int32 Seed = 1; Seed <= NumSeeds; ++Seed)
+		{
+			OutBeautifiedNames.Add(FString::Printf(TEXT("Seed %d"), Seed));
+			OutTestCommands.Add(FString::FromInt(Seed));
+		}
+	}
+
+	FString FindFirstMismatch(const TArray<FString>& Expected, const TArray<FString>& Actual)
+	{
+		int32 ExpectedIndex = 0;
+		int32 ActualIndex = 0;
+		while (ExpectedIndex < Expected.Num() || ActualIndex < Actual.Num())
+		{
+			const bool bHasExpected = ExpectedIndex < Expected.Num();
+			const bool bHasActual = ActualIndex < Actual.Num();
+			if (bHasExpected && bHasActual && Expected[ExpectedIndex] == Actual[ActualIndex])
+			{
+				++ExpectedIndex;
+				++ActualIndex;
+				continue;
+			}
+			if (!bHasActual || (bHasExpected && Expected[ExpectedIndex] < Actual[ActualIndex]))
+			{
+				return FString::Printf(TEXT("missing %s"), *Expected[ExpectedIndex]);
+			}
+			return FString::Printf(TEXT("unexpected %s"), *Actual[ActualIndex]);
+		}
+		return FString();
+	}
+}
+
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+class ACrvTestActorBase;
+class UWorld;
+
+namespace CtrlRefViz::Tests
+{
+	struct FCrvTopologySettings
+	{
+		int32 NumActors = 100;
+		// grid cell size, actors are laid out in a square grid
+		double Spacing = 500.0;
+		// references written per actor, spread over the property kinds below
+		int32 RefsPerActor = 4;
+		// fraction of actors spawned with a child actor
+		float ChildActorFraction = 0.f;
+		// write references into nested structs & instanced subobjects, not just top level properties
+		bool bNestedReferences = true;
+		int32 Seed = 0;
+	};
+
+	/**
+	 * Transient editor world for tests, destroyed with this object.
+	 */
+	class FCrvTestWorld
+	{
+	public:
+		FCrvTestWorld();
+		~FCrvTestWorld();
+
+		UWorld* GetWorld() const { return World; }
+
+	private:
+		UWorld* World = nullptr;
+	};
+
+	// Spawn a grid of test actors & fill their reference properties at random
+	TArray<ACrvTestActorBase*> SpawnTopology(UWorld* World, const FCrvTopologySettings& Settings);
+
+	// One complex automation test per seed, 1 to NumSeeds, the seed is the test command
+	void GetSeedTests(int32 NumSeeds, TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands);
+
+	// First entry in only one of two sorted lists, empty if they are the same
+	FString FindFirstMismatch(const TArray<FString>& Expected, const TArray<FString>& Actual);
+}
+
+#endif
@@ -4,6 +4,8 @@
 #include "CoreMinimal.h"
 #include "ComponentVisualizer.h"
 
+struct FCrvLines;
+
 struct CTRLREFERENCEVISUALIZER_API HCrvHitProxy : public HComponentVisProxy
 {
 	DECLARE_HIT_PROXY();
@@ -34,3 +36,26 @@ struct CTRLREFERENCEVISUALIZER_API HCrvHitProxy : public HComponentVisProxy
 		return EMouseCursor::EyeDropper;
 	}
 };
+
+/**
+ * Hit proxy shared by a cluster of reference lines.
+ * The line under the cursor is resolved on the CPU, see FCrvLines::FindNearestLine.
+ */
+struct CTRLREFERENCEVISUALIZER_API HCrvLineClusterHitProxy : public HCrvHitProxy
+{
+	DECLARE_HIT_PROXY();
+	const TSharedPtr<const FCrvLines> Lines;
+	const int32 ClusterIndex;
+
+	HCrvLineClusterHitProxy(const UActorComponent* ParentComponent, const UObject* InRootObject, const TSharedPtr<const FCrvLines>& InLines, const int32 InClusterIndex)
+		: HCrvHitProxy(ParentComponent, InRootObject, nullptr),
+		Lines(InLines),
+		ClusterIndex(InClusterIndex)
+	{
+	}
+
+	// Index of the line in this cluster closest to the ray, or INDEX_NONE
+	int32 FindNearestLine(const FVector& RayOrigin, const FVector& RayDirection, FVector& OutClosestPoint) const;
+
+	virtual EMouseCursor::Type GetMouseCursor() override;
+};
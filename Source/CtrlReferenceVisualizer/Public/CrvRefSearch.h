@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "CoreMinimal.h"
+#include "CrvSettings.h"
 #include "CrvUtils.h"
 #include "UObject/ReferenceChainSearch.h"
 
@@ -10,7 +11,7 @@ struct FCrvMenuItem
 {
 	FName Name;
 	FText Label;
-	FText ToolTip;
+	TAttribute<FText> ToolTip;
 	FSlateIcon Icon;
 	FUIAction Action;
 };
@@ -20,6 +21,14 @@ namespace CtrlRefViz::Search
 	FString LexToString(const FReferenceChainSearch::FReferenceChain* Chain);
 	bool IsExternal(const FReferenceChainSearch::FReferenceChain* Chain);
 	FCrvSet FindTargetObjects(UObject* RootObject);
+	// Paths of object properties in Referencer (including inside structs & containers) whose value passes IsReferenced
+	TArray<FString> FindPropertyPaths(const UObject* Referencer, TFunctionRef<bool(const UObject*)> IsReferenced);
+	// Paths of the properties holding a reference between RootObject (searched as TargetObjects) and LeafObject.
+	// Only reads properties, safe to call off the game thread while objects can't be collected.
+	TArray<FString> FindReferencePaths(const UObject* RootObject, const FCrvSet& TargetObjects, const UObject* LeafObject, ECrvDirection Direction);
+	// Whether values of Property can reference objects: object, soft, weak, lazy & interface properties, including inside structs & containers.
+	// Null (unknown) properties are assumed to.
+	bool CanHoldReferences(const FProperty* Property);
 }
 
 class FCrvRefSearch
@@ -29,7 +38,17 @@ public:
 
 	static void FindOutRefs(FCrvSet RootObjects, FCrvObjectGraph& Graph);
 	static void FindInRefs(FCrvSet RootObjects, FCrvObjectGraph& Graph);
+	// Same edges as FindInRefs, but scans for referencers once for all roots instead of once per root.
+	// Each referencer is attributed back to its roots by an outgoing search of the referencer.
+	static void FindInRefsBatched(FCrvSet RootObjects, FCrvObjectGraph& Graph);
 	
 	static FCrvMenuItem MakeMenuEntry(const UObject* Parent, const UObject* Object);
+	// Built when first shown, memoized per object until ResetToolTips
+	static TAttribute<FText> MakeToolTip(const UObject* Object);
+	static void ResetToolTips();
+	// Describe a single reference between RootObject and LeafObject, including the properties holding it
+	static FString DescribeReference(const UObject* RootObject, const UObject* LeafObject, ECrvDirection Direction);
+	// Describe a reference between RootObject and an actor in an unloaded World Partition cell
+	static FString DescribeUnloadedReference(const UObject* RootObject, FName LeafLabel, const FSoftObjectPath& LeafPath, ECrvDirection Direction);
 	static bool CanDisplayReference(const UObject* RootObject, const UObject* LeafObject);
 };
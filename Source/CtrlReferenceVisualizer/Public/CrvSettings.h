@@ -154,6 +154,22 @@ struct FCrvStyleSettings
 	/* Circle around referenced actors or scene components */
 	UPROPERTY(Config, EditAnywhere, Category = "Style | Target Circles", meta = (EditCondition = "bDrawTargetCircles"))
 	FLinearColor LinkedCircleColor = FLinearColor::Transparent;
+
+	/* References added since the compared graph, see ctrl.ReferenceVisualizer.DiffGraph */
+	UPROPERTY(Config, EditAnywhere, Category = "Style | Graph Diff")
+	FLinearColor DiffAddedColor = FLinearColor::Green;
+
+	/* References removed since the compared graph */
+	UPROPERTY(Config, EditAnywhere, Category = "Style | Graph Diff")
+	FLinearColor DiffRemovedColor = FLinearColor::Red;
+
+	/* References that can break streaming, see Show Only Spatial Issues */
+	UPROPERTY(Config, EditAnywhere, Category = "Style | Spatial Issues")
+	FLinearColor SpatialIssueColor = FLinearColor(1.f, 0.5f, 0.f);
+
+	/* References between actors in the same reference cycle, see Highlight Cycles */
+	UPROPERTY(Config, EditAnywhere, Category = "Style | Cycles")
+	FLinearColor CycleColor = FLinearColor(1.f, 0.f, 1.f);
 };
 
 USTRUCT()
@@ -286,6 +302,10 @@ public:
 	UPROPERTY(Config, EditAnywhere, Category = "General", DisplayName = "Visualize Incoming References (Potentially Slow)")
 	bool bShowIncomingReferences = true;
 
+	/* Read references to & from actors in unloaded World Partition cells from their actor descriptors */
+	UPROPERTY(Config, EditAnywhere, Category = "General", DisplayName = "Visualize References to Unloaded Actors")
+	bool bShowUnloadedActorReferences = true;
+
 	UPROPERTY(Config, EditAnywhere, Category = "General", DisplayName = "Move Camera to Reference On Select")
 	bool bMoveViewportCameraToReference = false;
 
@@ -299,6 +319,26 @@ public:
 	UPROPERTY(Config, EditAnywhere, Category = "General|Bounds", meta = (EditCondition = "bUseActorBounds"), DisplayName = "Include Child Actors")
 	bool bIncludeChildActorsInBounds = false;
 
+	/* Only draw hard references between actors that are far apart, or stream in different cells or data layers */
+	UPROPERTY(Config, EditAnywhere, Category = "General|Spatial", DisplayName = "Show Only Spatial Issues")
+	bool bShowOnlySpatialIssues = false;
+
+	/* References longer than this are spatial issues, 0 to ignore distance */
+	UPROPERTY(Config, EditAnywhere, Category = "General|Spatial", meta = (ClampMin = "0", UIMin = "0", UIMax = "1000", Units = "m"))
+	float SpatialMaxDistance = 100.f;
+
+	/* Size of the World Partition runtime grid cells, references into another cell are spatial issues. 0 to ignore cells */
+	UPROPERTY(Config, EditAnywhere, Category = "General|Spatial", meta = (ClampMin = "0", UIMin = "0", UIMax = "1000", Units = "m"))
+	float SpatialCellSize = 128.f;
+
+	/* References to actors in data layers the referencer isn't in are spatial issues */
+	UPROPERTY(Config, EditAnywhere, Category = "General|Spatial")
+	bool bSpatialCheckDataLayers = true;
+
+	/* Draw references between actors that (indirectly) reference each other in the cycle color. Cycles are complete in All mode */
+	UPROPERTY(Config, EditAnywhere, Category = "General|Cycles")
+	bool bHighlightCycles = true;
+
 	/* Controls the style of the reference viewer debug drawing */
 	UPROPERTY(Config, EditAnywhere, Category = "Style", meta = (ShowOnlyInnerProperties))
 	FCrvStyleSettings Style;
@@ -8,6 +8,9 @@
 
 class UToolMenu;
 class FCrvDebugVisualizer;
+class FCrvLinePicker;
+class FCrvClassInfoCache;
+struct FCrvClassInfo;
 class UReferenceVisualizerComponent;
 class UCrvSettings;
 class UCrvRefCache;
@@ -23,7 +26,9 @@ public:
 	void MakeActorOptionsSubmenu(UToolMenu* Menu) const;
 	void InitLevelMenus() const;
 
+	// Register the Reference Explorer tab spawner
 	void InitTab();
+	static const FName ExplorerTabName;
 
 	void OnPostEngineInit();
 	/** IModuleInterface implementation */
@@ -56,11 +61,17 @@ public:
 
 	static bool IsEnabled();
 	static bool IsDebugEnabled();
+
+	FCrvLinePicker* GetLinePicker() const { return LinePicker.Get(); }
+	// Menu section & icon for a class, shared by all reference lists
+	FCrvClassInfo GetClassInfo(const UClass* Class) const;
 	
 protected:
 	static void InitCategories();
 	FToolMenuEntry GetSettingsMenuEntry() const;
 	TArray<FName> RegisteredClasses;
 	FDelegateHandle SettingsModifiedHandle;
+	TSharedPtr<FCrvLinePicker> LinePicker;
+	TSharedPtr<FCrvClassInfoCache> ClassInfoCache;
 };
 
@@ -3,15 +3,50 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "CrvActorDescGraph.h"
+#include "CrvCycleIndex.h"
+#include "CrvDegreeStats.h"
+#include "CrvLocationCache.h"
+#include "CrvNameIndex.h"
+#include "CrvSelectionTracker.h"
 #include "CrvRefCache.h"
 #include "CrvSettings.h"
+#include "CrvSpatialQuery.h"
 #include "DebugRenderSceneProxy.h"
 #include "Components/ActorComponent.h"
 #include "Debug/DebugDrawComponent.h"
 #include "Templates/TypeHash.h"
 #include "ReferenceVisualizerComponent.generated.h"
 
+class FColoredMaterialRenderProxy;
 class UReferenceVisualizerComponent;
+struct FCrvGraphDiff;
+
+// References of one object, returned by UReferenceVisualizerEditorSubsystem::FindReferences
+USTRUCT(BlueprintType)
+struct FCrvObjectReferences
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Reference Visualizer")
+	TObjectPtr<UObject> Object;
+
+	// Objects referenced by Object
+	UPROPERTY(BlueprintReadOnly, Category = "Reference Visualizer")
+	TArray<TObjectPtr<UObject>> Outgoing;
+
+	// Objects referencing Object
+	UPROPERTY(BlueprintReadOnly, Category = "Reference Visualizer")
+	TArray<TObjectPtr<UObject>> Incoming;
+};
+
+// A change from a graph diff highlighted in the viewport, stored by its root object
+struct FCrvDiffLine
+{
+	TWeakObjectPtr<UObject> Leaf;
+	ECrvDirection Direction = ECrvDirection::Outgoing;
+	bool bAdded = false;
+};
 class UCrvRefCache;
 
 UCLASS()
@@ -27,55 +62,180 @@ public:
 	UPROPERTY(Transient)
 	TObjectPtr<UCrvRefCache> MenuCache;
 
+	// Shared line endpoint locations, for all visualizer components
+	FCrvLocationCache LocationCache;
+
+	// Selected actors & components, updated once per tick
+	FCrvSelectionTracker SelectionTracker;
+
+	// World Partition actor references, built on first use per world
+	const FCrvActorDescGraph& GetActorDescGraph(UWorld* World);
+
+	// Labels of every object in Cache, for searching by name
+	FCrvNameIndex NameIndex;
+
+	// Actor reference cycles in Cache, updated with it
+	FCrvCycleIndex CycleIndex;
+
+	DECLARE_MULTICAST_DELEGATE(FOnLocationsChanged)
+	FOnLocationsChanged OnLocationsChanged;
+
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
 	virtual void Deinitialize() override;
 
 	void UpdateCache();
 
-	void OnObjectModified(UObject* Object);
+	/**
+	 * Find references to & from each object in one call, e.g. from Python validation scripts.
+	 * Objects the visualizer has already cached are read from the cache, the rest are searched together.
+	 * Results are in the same order as Objects, invalid objects get no references.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Reference Visualizer")
+	TArray<FCrvObjectReferences> FindReferences(const TArray<UObject*>& Objects, bool bOutgoing = true, bool bIncoming = true);
+
 	void OnPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent);
 	void OnSettingsModified(UObject* Object, FProperty* Property);
-	void OnSelectionChanged(UObject* SelectionObject);
+	void OnSelectionDelta(const FCrvSet& Added, const FCrvSet& Removed);
+	void OnComponentTransformChanged(USceneComponent* Component, ETeleportType Teleport);
+	void InvalidateLocation(const UObject* Object);
+	void OnCacheUpdated();
+	void InvalidateActorDescGraph();
+
+	// Highlight changes between two graphs in the viewport until cleared, changes between objects that aren't loaded are skipped
+	void ShowGraphDiff(const FCrvGraphDiff& Diff);
+	void ClearGraphDiff();
+	const TArray<FCrvDiffLine>* GetDiffLines(const UObject* RootObject) const;
+
+	// Reference counts of every actor in World, cached references are reused & the rest searched together
+	FCrvDegreeStats ComputeDegreeStats(UWorld* World);
+
+	// Cached references that can break streaming in World, rebuilt on first use after the cache or locations change
+	const FCrvSpatialQuery& GetSpatialQuery(UWorld* World);
+
+	// Visualizer components by world, kept up to date by the components as they register & unregister
+	void RegisterComponent(UReferenceVisualizerComponent* Component);
+	void UnregisterComponent(UReferenceVisualizerComponent* Component);
+	// Owners of the visualizer components registered in World
+	FCrvSet GetRegisteredOwners(const UWorld* World) const;
 
 private:
+	TMap<TObjectKey<UWorld>, TSet<TObjectKey<UReferenceVisualizerComponent>>> ComponentsByWorld;
+	TMap<TObjectKey<UObject>, TArray<FCrvDiffLine>> DiffLines;
+	FCrvSpatialQuery SpatialQuery;
+	TWeakObjectPtr<UWorld> SpatialQueryWorld;
+	bool bIsSpatialQueryDirty = true;
 	bool bIsRefreshingSelection = false;
+	FCrvActorDescGraph ActorDescGraph;
+	FDelegateHandle MapOpenedHandle;
+	FDelegateHandle PackageSavedHandle;
 	FDelegateHandle SettingsModifiedHandle;
 	FTimerHandle UpdateCacheNextTickHandle;
 };
 
-USTRUCT()
-struct FCrvLine
+enum class ECrvObjectKind : uint8
 {
-	GENERATED_BODY()
-	UPROPERTY()
-	FVector Start;
-	UPROPERTY()
-	FVector End;
-	UPROPERTY()
-	FLinearColor Color;
-	UPROPERTY()
-	FCrvLineStyle Style;
-
-	friend bool operator==(const FCrvLine& Lhs, const FCrvLine& RHS)
+	Actor,
+	Component,
+	Object,
+	Num,
+};
+
+// Resolved style for a group of lines, lines store an index into the palette
+struct FCrvLinePaletteEntry
+{
+	FColor Color;
+	ECrvLineType LineType = ECrvLineType::Arrow;
+	float ArrowSize = 0.f;
+};
+
+// Actor at the end of a line into an unloaded World Partition cell, see FCrvActorDescNode
+struct FCrvUnloadedLeaf
+{
+	FName Label;
+	FSoftObjectPath ActorPath;
+	FBox Bounds = FBox(ForceInit);
+};
+
+// Range of FCrvLines::ClusteredLines, lines in a cluster share one hit proxy
+struct FCrvLineCluster
+{
+	int32 First = 0;
+	int32 Num = 0;
+};
+
+/**
+ * Reference lines stored as flat arrays, one entry per line in each array.
+ * Styles are shared through a small palette indexed by direction & object kind.
+ */
+struct FCrvLines
+{
+	TArray<FVector3f> Starts;
+	TArray<FVector3f> Ends;
+	TArray<uint8> PaletteIndices;
+	// Object at the other end of each line (the root is the component owner)
+	TArray<TWeakObjectPtr<const UObject>> Leaves;
+	// Unloaded actors by line index, these lines have no leaf object
+	TMap<int32, FCrvUnloadedLeaf> UnloadedLeaves;
+	TArray<FCrvLinePaletteEntry> Palette;
+	// Bounds of all line points
+	FBox Bounds = FBox(ForceInit);
+
+	// Line indices grouped by cluster, see BuildClusters
+	TArray<int32> ClusteredLines;
+	TArray<FCrvLineCluster> Clusters;
+
+	static uint8 GetPaletteIndex(const ECrvDirection Direction, const ECrvObjectKind Kind)
 	{
-		return Lhs.Start == RHS.Start
-			&& Lhs.End == RHS.End
-			&& Lhs.Color == RHS.Color
-			&& Lhs.Style == RHS.Style;
+		return static_cast<uint8>(Direction) * static_cast<uint8>(ECrvObjectKind::Num) + static_cast<uint8>(Kind);
 	}
 
-	friend bool operator!=(const FCrvLine& Lhs, const FCrvLine& RHS)
+	// Graph diff entries follow the direction & kind entries
+	static uint8 GetDiffPaletteIndex(const ECrvDirection Direction, const bool bAdded)
 	{
-		return !(Lhs == RHS);
+		return GetPaletteIndex(ECrvDirection::Outgoing, ECrvObjectKind::Num) + static_cast<uint8>(Direction) * 2 + (bAdded ? 1 : 0);
 	}
 
-	friend uint32 GetTypeHash(const FCrvLine& Arg)
+	// Spatial issue entries follow the graph diff entries
+	static uint8 GetSpatialPaletteIndex(const ECrvDirection Direction)
 	{
-		uint32 Hash = HashCombine(GetTypeHash(Arg.Start), GetTypeHash(Arg.End));
-		Hash = HashCombine(Hash, GetTypeHash(Arg.Color));
-		Hash = HashCombine(Hash, GetTypeHash(Arg.Style));
-		return Hash;
+		return GetDiffPaletteIndex(ECrvDirection::Outgoing, true) + 1 + static_cast<uint8>(Direction);
 	}
+
+	// Cycle entries follow the spatial issue entries
+	static uint8 GetCyclePaletteIndex(const ECrvDirection Direction)
+	{
+		return GetSpatialPaletteIndex(ECrvDirection::Outgoing) + 1 + static_cast<uint8>(Direction);
+	}
+
+	static ECrvDirection GetPaletteDirection(const uint8 PaletteIndex)
+	{
+		const uint8 NumKindEntries = GetPaletteIndex(ECrvDirection::Outgoing, ECrvObjectKind::Num);
+		if (PaletteIndex >= GetCyclePaletteIndex(ECrvDirection::Incoming))
+		{
+			return static_cast<ECrvDirection>(PaletteIndex - GetCyclePaletteIndex(ECrvDirection::Incoming));
+		}
+		if (PaletteIndex >= GetSpatialPaletteIndex(ECrvDirection::Incoming))
+		{
+			return static_cast<ECrvDirection>(PaletteIndex - GetSpatialPaletteIndex(ECrvDirection::Incoming));
+		}
+		if (PaletteIndex >= NumKindEntries)
+		{
+			return static_cast<ECrvDirection>((PaletteIndex - NumKindEntries) / 2);
+		}
+		return static_cast<ECrvDirection>(PaletteIndex / static_cast<uint8>(ECrvObjectKind::Num));
+	}
+
+	void BuildPalette(const UCrvSettings* Config);
+	void Add(const FVector& Start, const FVector& End, uint8 PaletteIndex, const UObject* Leaf);
+	// Group lines by the grid cell of their midpoint, splitting cells with more than MaxLinesPerCluster lines
+	void BuildClusters(double CellSize, int32 MaxLinesPerCluster);
+	// Closest line in Cluster to the ray, measured as angle from the ray origin. INDEX_NONE if cluster is empty.
+	int32 FindNearestLine(const FCrvLineCluster& Cluster, const FVector& RayOrigin, const FVector& RayDirection, FVector& OutClosestPoint) const;
+	void Reserve(int32 Number);
+	void Reset();
+
+	int32 Num() const { return PaletteIndices.Num(); }
+	SIZE_T GetAllocatedSize() const;
 };
 
 /**
@@ -91,9 +251,19 @@ class CTRLREFERENCEVISUALIZER_API UReferenceVisualizerComponent : public UDebugD
 public:
 	virtual FDebugRenderSceneProxy* CreateDebugSceneProxy() override;
 
-	FCrvLine CreateLine(const FVector& SrcOrigin, const FVector& DstOrigin, ECrvDirection Direction, const UClass* Type);
+	static ECrvObjectKind GetObjectKind(const UClass* Type);
+
+	void CreateLine(FCrvLines& OutLines, const FVector& SrcOrigin, const FVector& DstOrigin, ECrvDirection Direction, const UObject* Leaf) const;
+
+	void CreateLines(FCrvLines& OutLines, const UObject* RootObject, ECrvDirection Direction) const;
+	// Lines to actors in unloaded World Partition cells, ending at their descriptor bounds
+	void CreateUnloadedLines(FCrvLines& OutLines, const UObject* RootObject, ECrvDirection Direction) const;
+	// Lines for highlighted graph diff changes, see UReferenceVisualizerEditorSubsystem::ShowGraphDiff
+	void CreateDiffLines(FCrvLines& OutLines, const UObject* RootObject) const;
+	// Lines for references that can break streaming, drawn instead of all other lines when Show Only Spatial Issues is set
+	void CreateSpatialLines(FCrvLines& OutLines, const UObject* RootObject) const;
 
-	void CreateLines(const UObject* RootObject, ECrvDirection Direction);
+	void UpdateDebugBounds(const FCrvLines& Lines);
 
 	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
 	virtual void OnRegister() override;
@@ -102,8 +272,11 @@ public:
 	UPROPERTY(Transient)
 	TObjectPtr<UReferenceVisualizerEditorSubsystem> CrvEditorSubsystem;
 
-	UPROPERTY(Transient)
-	TSet<FCrvLine> Lines;
+	// Bounds of the lines handed to the last scene proxy
+	FBox LinesBounds = FBox(ForceInit);
+	// Owner actor bounds relative to this component, when lines were built
+	FBox OwnerLocalBounds = FBox(ForceInit);
+	bool bHasDebugBounds = false;
 
 	UReferenceVisualizerComponent();
 };
@@ -115,6 +288,7 @@ public:
 	static FVector GetActorOrigin(const AActor* Actor);
 
 	FCtrlReferenceVisualizerSceneProxy(const UPrimitiveComponent* InComponent);
+	virtual ~FCtrlReferenceVisualizerSceneProxy() override;
 
 	virtual SIZE_T GetTypeHash() const override;
 
@@ -122,6 +296,8 @@ public:
 
 	virtual uint32 GetMemoryFootprint() const override;
 
+	virtual HHitProxy* CreateHitProxies(UPrimitiveComponent* Component, TArray<TRefCountPtr<HHitProxy>>& OutHitProxies) override;
+
 	virtual void GetDynamicMeshElementsForView(
 		const FSceneView* View,
 		int32 ViewIndex,
@@ -132,12 +308,23 @@ public:
 		FMaterialCache& SolidMeshMaterialCache
 	) const override;
 
-	void DrawLines(TSet<FCrvLine> InLines);
+	void DrawLines(FCrvLines&& InLines);
 
 	static FVector GetObjectLocation(const UObject* Object);
 
 private:
 	ESceneDepthPriorityGroup DepthPriorityGroup = SDPG_World;
+	// update pass the lines were built in, reported while drawing so a pass can be followed onto the render thread
+	uint32 PassId = 0;
+	// shared with the line cluster hit proxies, immutable once drawn
+	TSharedPtr<const FCrvLines> CrvLines;
+	// one per CrvLines->Clusters, owned by the primitive scene info
+	TArray<HHitProxy*> ClusterHitProxies;
+	// wireframe material per mesh colour, created on first use by the render thread & freed with the proxy
+	mutable TMap<FColor, TUniquePtr<FColoredMaterialRenderProxy>> MeshMaterials;
+	mutable FCriticalSection MeshMaterialsLock;
+
+	const FColoredMaterialRenderProxy* GetMeshMaterial(const FColor& Color) const;
 
 protected:
 	inline static bool bMultiple = false;